@@ -11,34 +11,61 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "frogger_sim.h"
+#include "frogger_levelgen.h"
+#include "frogger_replay.h"
+#include "frogger_perf.h"
+#include "frogger_atlas.h"
+#include "frogger_textures.h"
+#include "frogger_assetpack.h"
+#include "frogger_pacer.h"
+#include "frogger_snapshot.h"
+#include "frogger_input.h"
+#include "frogger_env.h"
+#include "frogger_batch.h"
 
-// help with directions of objects
-enum Direction{
-    Left,
-    Right
+// what the window loop is doing, RunGame moves between these
+enum GameState{
+    Playing,
+    Paused,          // waiting in IdleUntilResumed
+    GameOver,        // game over screen until restart or quit
+    LevelTransition, // lanes were just respawned for the next level
+    Quit
 };
 
-// Objects in game
-struct Log{
-    Log(SDL_Rect pos_, int speed_, Direction dir_){
-        pos = pos_;
-        speed = speed_;
-        dir = dir_;
-    }
-    SDL_Rect pos;
-    int speed;
-    Direction dir;
+// why the game loop is waiting instead of running
+enum IdleReason{
+    IdlePaused,
+    IdleUnfocused
 };
 
-struct Enemy{
-    Enemy(SDL_Rect pos_, int speed_, Direction dir_){
-        pos = pos_;
-        speed = speed_;
-        dir = dir_;
-    }
-    SDL_Rect pos;
-    int speed;
-    Direction dir;
+// fixed tick clock of the simulation, in performance counter units
+struct TickClock{
+    Uint64 tickLength;  // replays may run faster
+    int maxSteps;       // most ticks one wake up may run
+    Uint64 previous;
+    Uint64 accumulator;
+};
+
+// the simulation thread and what the window loop shares with it
+// the window thread only touches game while the simulation isn't running
+struct SimThread{
+    std::thread thread;
+    std::mutex lock;              // held while ticks run, guards the fields below
+    std::condition_variable wake;
+    bool running;                 // ticks only advance while true
+    bool stop;                    // ends the thread
+    TickClock clock;
+    InputRing inputs;             // key presses from the window thread, lock free
+    std::vector<Action> pendingActions; // presses taken for the tick being run, only the thread uses it
+    std::atomic<int> outcome;     // GameOver or Quit once the simulation ends the game
+    double perfTotals[PerfPhaseCount]; // what the thread's timers added up to so far
 };
 
 // PROTOTYPES
@@ -47,263 +74,988 @@ bool InitSDL();
 bool CreateWindow();
 bool CreateRenderer();
 void SetupRenderer();
-SDL_Texture * LoadTexture(const std::string &str);
 void Render();
+void DrawScene(const Snapshot &view);
+void DrawStaticLayer(const Snapshot &view);
+bool BuildStaticLayer(const Snapshot &view);
+void DrawBackgroundAndBars(const Snapshot &view);
+void DrawPerfOverlay(const Snapshot &view);
+bool PollEvent(SDL_Event &event);
+bool HandleRenderReset(const SDL_Event &event);
+bool WindowActive();
+bool IdleUntilResumed(IdleReason reason);
+void DrawNumber(int value, int x, int y);
 void RunGame();
-void AddEnemy();
-void AddLog(Direction dir );
-void MoveEnemies();
-void MoveLogs();
-void ResetPlayerPos();
-bool CheckCollision( const SDL_Rect &rect1, const SDL_Rect &rect2);
-bool CheckEnemyCollisions();
-bool CheckLogCollisions();
-Log * getLog();
-void addEnemies();
-void loadObjects(bool);
-void gameOver();
+GameState PlayFrame(IdleReason &pauseReason, int &shownLevel);
+void StartSim();
+void StopSim();
+void PauseSim();
+void ResumeSim(bool newGame);
+void QueueAction(Action action);
+void DropInputs();
+void SimLoop();
+void CountSimPerf(const Snapshot &view);
+bool loadObjects();
+void UploadAtlas(AssetPack &pack, bool packed, bool showBackground);
+void ReloadAtlas();
+void ShowBackground();
+void InitPacing();
+GameState gameOver();
+int RunHeadless(unsigned long ticks);
+int RunEnvHeadless(unsigned long steps);
+int RunBatchHeadless(unsigned long steps, int games, int threads);
+int RunReplayHeadless();
+TickResult SimulateTick(std::vector<Action> &pendingActions);
+void Record(ReplayEventType type, int value = 0);
+const LevelPool * ActivePool();
+const SDL_Rect * ToSDLRect(const Rect &rect);
 
 // Global Variables
 SDL_Rect windowRect = {900, 200, 300, 500};
 
-int movementFactor = 25;
-int lastEnemyPos = 50;
+uint64_t seed = time(NULL); // every random layout and input follows from this
 
 SDL_Window * window;
 SDL_Renderer* renderer;
 
-SDL_Rect playerPos;
-SDL_Rect topBar;
-SDL_Rect bottomBar;
 SDL_Rect backgroundPos;
 
-SDL_Texture* enemyTexture;
-SDL_Texture* logTexture;
-SDL_Texture* playerTexture;
-SDL_Texture* backgroundTexture;
-SDL_Texture* barTexture;
+Atlas atlas;           // every sprite in one texture, owned by textures
+SpriteLoader spriteLoader; // decodes the atlas sprites during startup
+TextureCache textures; // owns the atlas texture, the game over screen is a sprite of it
+TextureHandle atlasTexture = noTexture; // held while the window is open
+const char * const atlasKey = "atlas";
+
+SDL_Texture *staticLayer = NULL; // background and bars composited once
+int staticLayerLevel = -1;       // level staticLayer was drawn for, -1 to redraw
+
+Game game;
+LevelPool levelPool; // empty unless --levels is given
+
+ReplayWriter recorder;        // open when --record is given
+ReplayReader replay;          // loaded when --replay is given
+bool replaying = false;
+double replaySpeed = 1.0;     // playback speed of a rendered replay
+unsigned long replayTick = 0; // ticks run since start, stamps replay events
+unsigned long replayDiverged = 0; // ticks whose outcome didn't match the replay
+
+bool showPerf = false; // frame timing overlay, toggled with o
+
+SimThread sim;            // steps game while playing
+SnapshotBuffer snapshots; // sim writes, Render draws the newest
+double simPerfCounted[PerfPhaseCount]; // sim perf totals already added to a frame
 
-std::vector<Enemy> enemies;
-std::vector<Log> logs;
+FramePacer pacer;
+const int idleTimeoutMs = 500; // longest an idle wait blocks before looking again
+double frameRate = 0; // frames per second, 0 follows the display and uses vsync
 
 // main function
+// --headless runs the game without a window as fast as possible
+// --record saves the inputs of the run, --replay plays a saved run back
 int main(int argc, char*args[]){
-    loadObjects(true);
-    RunGame();
+    bool headless = false;
+    bool env = false;
+    int batchGames = 0;
+    unsigned long ticks = 100000;
+    std::string recordPath;
+    std::string replayPath;
+    LevelGenOptions levelOptions = DefaultLevelGenOptions();
+    levelOptions.poolSize = 0;
+
+    for(int i = 1; i < argc; i++){
+        std::string arg = args[i];
+        if(arg == "--headless")
+            headless = true;
+        else if(arg == "--env")
+            env = true;
+        else if(arg == "--batch" && i + 1 < argc)
+            batchGames = atoi(args[++i]);
+        else if(arg == "--ticks" && i + 1 < argc)
+            ticks = strtoul(args[++i], NULL, 10);
+        else if(arg == "--seed" && i + 1 < argc)
+            seed = strtoull(args[++i], NULL, 10);
+        else if(arg == "--levels" && i + 1 < argc)
+            levelOptions.poolSize = atoi(args[++i]);
+        else if(arg == "--threads" && i + 1 < argc)
+            levelOptions.threads = atoi(args[++i]);
+        else if(arg == "--record" && i + 1 < argc)
+            recordPath = args[++i];
+        else if(arg == "--replay" && i + 1 < argc)
+            replayPath = args[++i];
+        else if(arg == "--speed" && i + 1 < argc)
+            replaySpeed = atof(args[++i]);
+        else if(arg == "--fps" && i + 1 < argc)
+            frameRate = atof(args[++i]);
+        else{
+            std::cout << "usage: " << args[0] << " [--headless] [--env] [--batch N] [--ticks N] [--seed S]"
+                      << " [--levels N] [--threads T] [--record FILE] [--replay FILE] [--speed X] [--fps N]" << std::endl;
+            return 1;
+        }
+    }
+
+    // a replay brings its own seed, window and levels
+    if(!replayPath.empty()){
+        if(!OpenReplayReader(replay, replayPath)){
+            std::cout << "Failed to read replay " << replayPath << std::endl;
+            return 1;
+        }
+        replaying = true;
+        seed = replay.header.seed;
+        windowRect.w = replay.header.width;
+        windowRect.h = replay.header.height;
+        levelOptions.poolSize = replay.header.levels;
+        if(replaySpeed <= 0) replaySpeed = 1.0;
+    }
+
+    // pregenerate solvable levels, 8 candidates for every level kept
+    if(levelOptions.poolSize > 0){
+        Game shape;
+        InitGame(shape, windowRect.w, windowRect.h, seed);
+        levelOptions.seed = seed;
+        levelOptions.candidates = levelOptions.poolSize * 8;
+
+        auto start = std::chrono::steady_clock::now();
+        int solvable = GenerateLevelPool(levelPool, shape, levelOptions);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "level pool: " << levelPool.levels.size() << " levels, " << solvable << " of "
+                  << levelOptions.candidates << " candidates solvable in " << elapsed.count() << "s" << std::endl;
+    }
+
+    if(!recordPath.empty() && !replaying){
+        ReplayHeader header = {seed, windowRect.w, windowRect.h, levelOptions.poolSize};
+        if(!OpenReplayWriter(recorder, recordPath, header)){
+            std::cout << "Failed to create replay " << recordPath << std::endl;
+            return 1;
+        }
+    }
+
+    int status = 0;
+    if(headless)
+        status = replaying ? RunReplayHeadless() : (env ? (batchGames > 0 ? RunBatchHeadless(ticks, batchGames, levelOptions.threads)
+                                               : RunEnvHeadless(ticks))
+                                        : RunHeadless(ticks));
+    else{
+        if(loadObjects())
+            RunGame();
+
+        std::cout << "textures: " << textures.hits << " hits, " << textures.misses << " misses, "
+                  << textures.bytesResident << " bytes resident" << std::endl;
+        ReleaseTexture(textures, atlasTexture);
+        ClearTextureCache(textures);
+        atlas.texture = NULL;
+        if(staticLayer != NULL)
+            SDL_DestroyTexture(staticLayer);
+    }
+    CloseReplayWriter(recorder);
+    return status;
+}
+
+// writes an event to the replay being recorded, if there is one
+void Record(ReplayEventType type, int value){
+    RecordEvent(recorder, replayTick, type, value);
+}
+
+// one simulation tick, moves come from the keyboard or from the replay
+// records what happened so the tick can be played back
+TickResult SimulateTick(std::vector<Action> &pendingActions){
+    // handle if player is on log (move with log)
+    BeginTick(game);
+    if(replaying)
+        ApplyReplayMoves(replay, game, replayTick);
+    for(auto action : pendingActions){
+        MovePlayer(game, action);
+        Record(MoveEventOf(action));
+    }
+    pendingActions.clear();
+
+    // move objects, check collisions and level up
+    // EndTick in its two halves so the overlay can time them apart, the
+    // rules themselves carry no timers
+    {
+        PERF_SCOPE(PerfMovement);
+        AdvanceLanes(game);
+    }
+    TickResult result;
+    {
+        PERF_SCOPE(PerfCollision);
+        result = SettlePlayer(game);
+    }
+    if(replaying){
+        if(!CheckReplayOutcome(replay, replayTick, result))
+            replayDiverged++;
+    }
+    else if(result == LevelUp)
+        Record(ReplayLevelUp, game.level);
+    else if(result == Dead)
+        Record(ReplayDeath);
+    replayTick++;
+    return result;
+}
+
+// steps the game without SDL using random inputs and reports how fast it ran
+// restarts the game whenever the player dies
+int RunHeadless(unsigned long ticks){
+    InitGame(game, windowRect.w, windowRect.h, seed, ActivePool());
+    Rng policy = MakeRng(seed, PolicyStreams);
+
+    std::vector<Action> pendingActions;
+    pendingActions.reserve(1);
+
+    unsigned long deaths = 0;
+    unsigned long levels = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < ticks; i++){
+        // lean towards moving up so levels actually get finished
+        Action action = NoAction;
+        switch(RandomBelow(policy, 8)){
+            case 0:
+            case 1:
+                action = MoveUp;
+                break;
+            case 2:
+                action = MoveDown;
+                break;
+            case 3:
+                action = MoveLeft;
+                break;
+            case 4:
+                action = MoveRight;
+                break;
+            default:
+                break;
+        }
+
+        if(action != NoAction)
+            pendingActions.push_back(action);
+
+        TickResult result = SimulateTick(pendingActions);
+        if(result == LevelUp)
+            levels++;
+        else if(result == Dead){
+            deaths++;
+            Record(ReplayRestart);
+            ResetGame(game);
+        }
+    }
+    Record(ReplayQuit);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "ticks: " << ticks << std::endl;
+    std::cout << "seed: " << seed << std::endl;
+    std::cout << "levels: " << levels << std::endl;
+    std::cout << "deaths: " << deaths << std::endl;
+    std::cout << "seconds: " << elapsed.count() << std::endl;
+    std::cout << "ticks/sec: " << (elapsed.count() > 0 ? ticks / elapsed.count() : 0) << std::endl;
+    return 0;
+}
+
+// steps the training env with random actions, every episode gets the next seed
+int RunEnvHeadless(unsigned long steps){
+    Env env;
+    InitEnv(env, ActivePool());
+    Rng policy = MakeRng(seed, PolicyStreams);
+
+    unsigned long episodes = 0;
+    unsigned long levels = 0;
+    double totalReward = 0;
+    ResetEnv(env, seed);
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < steps; i++){
+        // any action, moving up twice as likely so levels get finished
+        int choice = RandomBelow(policy, envActionCount + 1);
+        Action action = choice == envActionCount ? MoveUp : (Action)choice;
+
+        EnvStep step = StepEnv(env, action);
+        totalReward += step.reward;
+        if(step.result == LevelUp)
+            levels++;
+        if(step.done)
+            ResetEnv(env, seed + ++episodes);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "steps: " << steps << std::endl;
+    std::cout << "seed: " << seed << std::endl;
+    std::cout << "episodes: " << episodes << std::endl;
+    std::cout << "levels: " << levels << std::endl;
+    std::cout << "mean return: " << (episodes > 0 ? totalReward / episodes : totalReward) << std::endl;
+    std::cout << "seconds: " << elapsed.count() << std::endl;
+    std::cout << "steps/sec: " << (elapsed.count() > 0 ? steps / elapsed.count() : 0) << std::endl;
+    return 0;
+}
+
+// steps a batch of training envs with random actions, about steps game steps
+// in all, threads 0 uses every core
+int RunBatchHeadless(unsigned long steps, int games, int threads){
+    BatchEnv batch;
+    InitBatch(batch, games, seed, threads);
+    Rng policy = MakeRng(seed, PolicyStreams);
+    std::vector<Action> actions(games);
+
+    unsigned long rounds = (steps + games - 1) / games;
+    unsigned long episodes = 0;
+    double totalReward = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < rounds; i++){
+        for(int g = 0; g < games; g++){
+            int choice = RandomBelow(policy, envActionCount + 1);
+            actions[g] = choice == envActionCount ? MoveUp : (Action)choice;
+        }
+        StepBatch(batch, actions.data());
+        for(int g = 0; g < games; g++){
+            totalReward += batch.rewards[g];
+            episodes += batch.dones[g];
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    StopBatch(batch);
+
+    unsigned long total = rounds * games;
+    std::cout << "games: " << games << std::endl;
+    std::cout << "threads: " << batch.threads << std::endl;
+    std::cout << "steps: " << total << std::endl;
+    std::cout << "seed: " << seed << std::endl;
+    std::cout << "episodes: " << episodes << std::endl;
+    std::cout << "mean return: " << (episodes > 0 ? totalReward / episodes : totalReward) << std::endl;
+    std::cout << "seconds: " << elapsed.count() << std::endl;
+    std::cout << "steps/sec: " << (elapsed.count() > 0 ? total / elapsed.count() : 0) << std::endl;
+    return 0;
+}
+
+// plays a replay back without a window as fast as possible
+// and reports whether every death and level up happened as recorded
+int RunReplayHeadless(){
+    InitGame(game, windowRect.w, windowRect.h, seed, ActivePool());
+    std::vector<Action> pendingActions;
+
+    unsigned long deaths = 0;
+    unsigned long levels = 0;
+    bool dead = false;
+    bool quit = false;
+    auto start = std::chrono::steady_clock::now();
+    while(!quit){
+        // restarts, pauses and quits sit between ticks
+        ReplayEvent event;
+        while(NextControlEvent(replay, replayTick, event)){
+            if(event.type == ReplayRestart){
+                ResetGame(game);
+                dead = false;
+            }
+            else if(event.type == ReplayQuit)
+                quit = true;
+        }
+        // the recording ends, or stops making sense, once the player is dead for good
+        if(quit || dead || !PeekReplayEvent(replay, event)) break;
+
+        TickResult result = SimulateTick(pendingActions);
+        if(result == LevelUp)
+            levels++;
+        else if(result == Dead){
+            deaths++;
+            dead = true;
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "ticks: " << replayTick << std::endl;
+    std::cout << "seed: " << seed << std::endl;
+    std::cout << "levels: " << levels << std::endl;
+    std::cout << "deaths: " << deaths << std::endl;
+    std::cout << "diverged ticks: " << replayDiverged << std::endl;
+    std::cout << "seconds: " << elapsed.count() << std::endl;
+    std::cout << "ticks/sec: " << (elapsed.count() > 0 ? replayTick / elapsed.count() : 0) << std::endl;
+    return replayDiverged == 0 ? 0 : 2;
+}
+
+// Rect and SDL_Rect share the same layout
+const SDL_Rect * ToSDLRect(const Rect &rect){
+    return reinterpret_cast<const SDL_Rect *>(&rect);
 }
 
 // funciton to load all the textures and set initial values of their locations
-void loadObjects(bool firstTime){
+// runs once, restarts reset the game in place and keep everything loaded here
+// false if SDL couldn't be set up
+bool loadObjects(){
     backgroundPos.x = 0;
     backgroundPos.y = 0;
     backgroundPos.w = windowRect.w;
     backgroundPos.h = windowRect.h;
     
-    if (firstTime){
-        // check for failed initialization
-        if( !InitEverything()) return;
-    }
-    // Load textures
-    enemyTexture        = LoadTexture("img/truck.png");
-    logTexture          = LoadTexture("img/logLong.png");
-    playerTexture       = LoadTexture("img/frog.png");
-    backgroundTexture   = LoadTexture("img/background.bmp");
-    barTexture          = LoadTexture("img/bar.bmp");
-    srand(time(NULL));
-    
-    // Adding moving objects
-    addEnemies();
-    
-    // Init top and bottom bar
-    topBar.x = 0;
-    topBar.y = 0;
-    topBar.w = windowRect.w;
-    topBar.h = 20;
+    // the decoder is set up here, before any loader thread can use it
+    if (!InitSpriteDecoding())
+        return false;
+
+    // a baked pack is uploaded as is, otherwise decode the sprites
+    // on other threads while SDL starts up
+    AssetPack pack;
+    bool packed = MapAssetPack(pack, assetPackPath);
+    if (!packed)
+        StartSpriteLoader(spriteLoader);
+
+    // check for failed initialization
+    if( !InitEverything()){
+        if (packed)
+            UnmapAssetPack(pack);
+        else
+            StopSpriteLoader(spriteLoader);
+        return false;
+    }
+    InitPacing();
+    InitTextureCache(textures);
+    UploadAtlas(pack, packed, true);
+
+    // Adding moving objects, bars and the player
+    InitGame(game, windowRect.w, windowRect.h, seed, ActivePool());
+    return true;
+}
 
-    bottomBar.x = 0;
-    bottomBar.y = windowRect.h - 20;
-    bottomBar.w = windowRect.w;
-    bottomBar.h = 20;
+// uploads the atlas from a mapped pack, or from what spriteLoader decodes
+// when there is none or it can't be used, then hands it to the texture cache
+// showBackground puts the background on screen while the rest decodes
+void UploadAtlas(AssetPack &pack, bool packed, bool showBackground){
+    if (packed){
+        packed = AtlasFromPack(atlas, renderer, pack);
+        UnmapAssetPack(pack);
+        if (!packed)
+            StartSpriteLoader(spriteLoader);
+    }
+    if (!packed){
+        if (showBackground)
+            ShowBackground();
+        FinishAtlas(atlas, renderer, spriteLoader);
+    }
+    atlasTexture = AdoptTexture(textures, atlasKey, atlas.texture);
+}
+
+// the device lost every texture, makes the atlas again the way startup did
+// handles to it stay good, they give the new texture
+void ReloadAtlas(){
+    ReleaseTexture(textures, atlasTexture);
+    AssetPack pack;
+    bool packed = MapAssetPack(pack, assetPackPath);
+    if (!packed)
+        StartSpriteLoader(spriteLoader);
+    UploadAtlas(pack, packed, false);
+}
 
-    // Initialize our player
-    playerPos.w = 20;
-    playerPos.h = 15;
-    ResetPlayerPos();
+// paces frames at --fps, or at the display's refresh rate when it isn't given
+// vsync only stays on when the renderer got it and no other rate was asked for
+void InitPacing(){
+    SDL_RendererInfo info;
+    bool vsync = frameRate <= 0 && SDL_GetRendererInfo(renderer, &info) == 0
+        && (info.flags & SDL_RENDERER_PRESENTVSYNC);
 
+    double hz = frameRate;
+    if(hz <= 0){
+        SDL_DisplayMode mode;
+        int display = SDL_GetWindowDisplayIndex(window);
+        hz = display >= 0 && SDL_GetCurrentDisplayMode(display, &mode) == 0 && mode.refresh_rate > 0
+            ? mode.refresh_rate : ticksPerSecond;
+    }
+    InitFramePacer(pacer, hz, vsync);
+}
+
+// puts the background on screen as soon as it is decoded
+// so the window isn't blank while the other sprites finish
+void ShowBackground(){
+    SDL_Surface *surface = WaitForSprite(spriteLoader, SpriteBackground);
+    if(surface == NULL) return;
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, NULL, &backgroundPos);
+    SDL_RenderPresent(renderer);
+    SDL_DestroyTexture(texture);
+}
+
+// the generated levels, or NULL to spawn random ones
+const LevelPool * ActivePool(){
+    return levelPool.levels.empty() ? NULL : &levelPool;
 }
 
 // funciton to run the actual game
+// one flat loop over the game states, restarts and level ups reuse the game
+// and everything loaded in loadObjects instead of starting another loop
+// the rules run on the simulation thread, this thread handles input and draws
 void RunGame(){
-    bool loop = true; // used to run game loop
-    bool paused = false; // used to handle if player pauses
-    bool onLog = false; // used to keep track if player is on log
-    Log *currLog; // what log the player is on
-    
-    while(loop){
-        SDL_Event event;
-        
-        // handle if player is on log (move with log)
-        if (onLog){
-            switch(currLog->dir){
-                case(Right):
-                    playerPos.x += currLog->speed;
+    GameState state = Playing;
+    IdleReason pauseReason = IdlePaused;
+    int shownLevel = game.level; // level the static layer is up to date with
+    perfStats.enabled = true;
+    StartSim();
+
+    while(state != Quit){
+        switch(state){
+            case Playing:
+                state = PlayFrame(pauseReason, shownLevel);
+                // the game stays still while nothing is playing
+                if(state != Playing && state != LevelTransition)
+                    PauseSim();
+                if(state == Paused)
+                    Record(ReplayPause);
+                else if(state == Quit)
+                    Record(ReplayQuit);
+                break;
+            case Paused:
+                if(IdleUntilResumed(pauseReason)){
+                    Record(ReplayResume);
+                    ResumeSim(false);
+                    state = Playing;
+                }
+                else{
+                    Record(ReplayQuit);
+                    state = Quit;
+                }
+                break;
+            case GameOver:
+                state = gameOver();
+                // a new game starts on a fresh clock with no leftover moves
+                if(state == Playing)
+                    ResumeSim(true);
+                break;
+            case LevelTransition:
+                // draw the new level's static layer now instead of in the middle of a frame
+                if(BuildStaticLayer(LatestSnapshot(snapshots)))
+                    staticLayerLevel = shownLevel;
+                state = Playing;
+                break;
+            default:
+                state = Quit;
+                break;
+        }
+    }
+    StopSim();
+}
+
+// handles input and draws the newest snapshot, the simulation runs on its own
+// so a slow present only costs frames, never ticks
+// returns the state the loop goes to next
+GameState PlayFrame(IdleReason &pauseReason, int &shownLevel){
+    // the simulation ends the game on a death or at the end of a replay
+    GameState next = (GameState)sim.outcome.exchange(Playing);
+    if(next != Playing) return next;
+    SDL_Event event;
+
+    // handle user inputs, events after a pause wait until it ends
+    while(next == Playing && PollEvent(event)){
+        if(event.type == SDL_QUIT)
+            next = Quit;
+        else if(event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_o)
+            showPerf = !showPerf;
+        // the next Render draws the static layer again
+        else if(HandleRenderReset(event))
+            continue;
+        // nobody is watching, hold the game like a pause until they are back
+        else if(event.type == SDL_WINDOWEVENT && (event.window.event == SDL_WINDOWEVENT_FOCUS_LOST
+                                                  || event.window.event == SDL_WINDOWEVENT_MINIMIZED)){
+            pauseReason = IdleUnfocused;
+            next = Paused;
+        }
+        else if(event.type == SDL_KEYDOWN && !replaying){
+            switch(event.key.keysym.sym){
+                case SDLK_RIGHT:
+                    QueueAction(MoveRight);
                     break;
-                case(Left):
-                    playerPos.x -= currLog->speed;
+                case SDLK_LEFT:
+                    QueueAction(MoveLeft);
+                    break;
+                case SDLK_DOWN:
+                    QueueAction(MoveDown);
+                    break;
+                case SDLK_UP:
+                    QueueAction(MoveUp);
+                    break;
+                // implement pause 
+                case SDLK_p:
+                    pauseReason = IdlePaused;
+                    next = Paused;
+                    break;
+                default:
                     break;
             }
         }
-        
-        // handle user inputs  
-        while(SDL_PollEvent(&event)){
-            if(event.type == SDL_QUIT)
-                loop = false;
-            else if(event.type == SDL_KEYDOWN){
-                switch(event.key.keysym.sym){
-                    case SDLK_RIGHT:
-                        playerPos.x += movementFactor;
-                        break;
-                    case SDLK_LEFT:
-                        playerPos.x -= movementFactor;
-                        break;
-                    case SDLK_DOWN:
-                        playerPos.y += movementFactor;
-                        break;
-                    case SDLK_UP:
-                        playerPos.y -= movementFactor;
-                        break;
-                    // implement pause 
-                    case SDLK_p:
-                        SDL_Event pauseEvent;
-                        paused = true;
-                        while(paused){
-                            while(SDL_PollEvent(&pauseEvent)){
-                                if (pauseEvent.type == SDL_QUIT){
-                                    loop = false;
-                                    paused = false;
-                                    continue;
-                                }
-                                else if(pauseEvent.type == SDL_KEYDOWN){
-                                    if (pauseEvent.key.keysym.sym == SDLK_p){
-                                        paused = false;
-                                    }
-                                }
-                            }
-                        }
-                        break;
-                    default:
-                        break;
-                }
-            }
-        }
-        
-        // move objects
-        MoveEnemies();
-        MoveLogs();
-
-        // Check collisions against enemies
-        if(CheckEnemyCollisions()){
-            gameOver();  
-            loop = false;  
-            continue;      
-        }
+    }
+    if(next != Playing) return next;
 
-        // Check collisions against logs
-        if (CheckLogCollisions()){
-            onLog = true;
-            currLog = getLog(); // getting log player is on
-        }
-        else{
-            onLog = false;
-            currLog = NULL;
+    // lanes were respawned since the last frame
+    const Snapshot &view = LatestSnapshot(snapshots);
+    if(view.level != shownLevel){
+        shownLevel = view.level;
+        return LevelTransition;
+    }
+
+    CountSimPerf(view);
+    Render();
+
+    // wait for the next frame
+    {
+        PERF_SCOPE(PerfDelay);
+        PaceFrame(pacer);
+    }
+    EndPerfFrame();
+    return next;
+}
+
+// starts the simulation thread with the game running
+void StartSim(){
+    TickClock &clock = sim.clock;
+    clock.tickLength = SDL_GetPerformanceFrequency() / (ticksPerSecond * (replaying ? replaySpeed : 1.0));
+    clock.maxSteps = replaying && replaySpeed > 1 ? maxCatchUpTicks * replaySpeed : maxCatchUpTicks;
+    clock.previous = SDL_GetPerformanceCounter();
+    clock.accumulator = 0;
+    InitInputRing(sim.inputs);
+    sim.pendingActions.reserve(inputRingSize);
+    sim.running = true;
+    sim.stop = false;
+    sim.outcome = Playing;
+    std::fill(sim.perfTotals, sim.perfTotals + PerfPhaseCount, 0.0);
+    std::fill(simPerfCounted, simPerfCounted + PerfPhaseCount, 0.0);
+
+    InitSnapshotBuffer(snapshots);
+    TakeSnapshot(SnapshotToWrite(snapshots), game);
+    PublishSnapshot(snapshots);
+    sim.thread = std::thread(SimLoop);
+}
+
+// ends the simulation thread and waits for it
+void StopSim(){
+    {
+        std::lock_guard<std::mutex> guard(sim.lock);
+        sim.stop = true;
+    }
+    sim.wake.notify_one();
+    sim.thread.join();
+}
+
+// stops the ticks, once this returns no tick is running and game can be touched
+void PauseSim(){
+    std::lock_guard<std::mutex> guard(sim.lock);
+    sim.running = false;
+}
+
+// lets the ticks run again, time spent paused is not owed to the simulation
+// a new game also drops ticks and moves left over from the last one
+void ResumeSim(bool newGame){
+    {
+        std::lock_guard<std::mutex> guard(sim.lock);
+        sim.clock.previous = SDL_GetPerformanceCounter();
+        if(newGame){
+            sim.clock.accumulator = 0;
+            DropInputs();
         }
-        
-        // handle if player is in water and not on log
-        if (!onLog && playerPos.y < 224 && playerPos.y > 45) { 
-            gameOver();
-            loop = false;
+        // a game that ended right as it was paused stays stopped, PlayFrame picks up the outcome
+        sim.running = sim.outcome == Playing;
+    }
+    sim.wake.notify_one();
+}
+
+// hands a key press to the tick it arrived during, never waits for the simulation
+// a press that finds the ring full is dropped
+void QueueAction(Action action){
+    PushInput(sim.inputs, action, SDL_GetPerformanceCounter());
+}
+
+// throws away presses nobody took yet, the window thread may only do this
+// while the simulation is paused since it takes the consumer's side of the ring
+void DropInputs(){
+    TimedAction input;
+    while(PeekInput(sim.inputs, input))
+        PopInput(sim.inputs);
+}
+
+// simulation thread, runs every tick that is due while the game is playing and
+// publishes a snapshot after each batch, it sleeps in between with the lock
+// released so pauses get through
+// the rules advance in fixed ticks so a late wake up catches up instead of slowing the lanes
+void SimLoop(){
+    std::unique_lock<std::mutex> guard(sim.lock);
+    TickClock &clock = sim.clock;
+    perfStats.enabled = true;
+    while(!sim.stop){
+        if(!sim.running){
+            sim.wake.wait(guard);
             continue;
         }
-        
-        // check if player is off screen
-        if(playerPos.y > windowRect.h)
-            playerPos.y = windowRect.h - 20;
-        else if(playerPos.x < 0)
-            playerPos.x = 0;
-        else if(playerPos.x > windowRect.w)
-            playerPos.x = windowRect.w - playerPos.w;
-
-
-        // check collision against top bar (win the level)
-        // since top bar covers the entire width, we only need to check y value
-        // topBar.y refers to the top of the top bar, so topBar.y + topBar.h
-        
-        if(playerPos.y < (topBar.y + topBar.h)){
-            ResetPlayerPos();
-
-            // increase speed of new objects
-            std::vector<int> logSpeeds;
-            std::vector<int> truckSpeeds;
-            for(auto &p : logs){
-               logSpeeds.push_back(p.speed);
+
+        Uint64 now = SDL_GetPerformanceCounter();
+        clock.accumulator += now - clock.previous;
+        clock.previous = now;
+
+        // run every tick that is due, each one takes the presses that arrived
+        // before it ends so a press lands on the tick it belongs to rather
+        // than the first tick of the batch
+        int steps = 0;
+        while(sim.running && clock.accumulator >= clock.tickLength && steps < clock.maxSteps){
+            GameState outcome = Playing;
+
+            // a replay says when it ends
+            ReplayEvent control;
+            while(replaying && NextControlEvent(replay, replayTick, control))
+                if(control.type == ReplayQuit)
+                    outcome = Quit;
+            if(replaying && !PeekReplayEvent(replay, control))
+                outcome = Quit;
+
+            if(outcome == Playing){
+                Uint64 tickEnd = now - clock.accumulator + clock.tickLength;
+                TakeInputsUntil(sim.inputs, tickEnd, sim.pendingActions);
+                if(SimulateTick(sim.pendingActions) == Dead)
+                    outcome = GameOver;
             }
-            for(auto &p : enemies)
-                truckSpeeds.push_back(p.speed); 
-            logs.clear();
-            enemies.clear();
-            lastEnemyPos = 50;
-            addEnemies();
-            int count = 0; 
-            for (auto &p : enemies){
-                p.speed = truckSpeeds[count] * 1.2; 
-                count++;
+            if(outcome != Playing){
+                sim.running = false;
+                sim.outcome = outcome;
             }
-            count = 0;
-            for (auto &p : logs){
-                p.speed = logSpeeds[count] * 1.2;
-                count++;
+            clock.accumulator -= clock.tickLength;
+            steps++;
+        }
+
+        // too far behind to catch up, drop the backlog rather than spiral
+        if(steps == clock.maxSteps)
+            clock.accumulator = 0;
+
+        if(steps > 0){
+            Snapshot &snapshot = SnapshotToWrite(snapshots);
+            TakeSnapshot(snapshot, game);
+            for(int p = 0; p < PerfPhaseCount; p++){
+                sim.perfTotals[p] += perfStats.current[p];
+                perfStats.current[p] = 0;
+                snapshot.perfTotals[p] = sim.perfTotals[p];
             }
-            
+            PublishSnapshot(snapshots);
         }
-        Render();
 
-        // add a 16 msec delay so it funs at ~60fps
-        SDL_Delay(16);
+        // sleep until the next tick is due, a pause or stop wakes it early
+        if(sim.running && clock.accumulator < clock.tickLength){
+            Uint64 wait = clock.tickLength - clock.accumulator;
+            sim.wake.wait_for(guard, std::chrono::nanoseconds(wait * 1000000000 / SDL_GetPerformanceFrequency()));
+        }
     }
-    return;
 }
 
-// loads png texture give string of the png's path
-SDL_Texture* LoadTexture(const std::string &str){
-    // Load image as SDL_Surface
-    SDL_Surface* surface = IMG_Load(str.c_str());
-    
-    // SDL Surface is just the raw pixels, so we convert it to a 
-    // hardware-optimized texture so we can render it
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+// adds the time the simulation thread spent since the last frame to this frame
+// so lane movement and collision still show in the overlay
+void CountSimPerf(const Snapshot &view){
+    for(int p = 0; p < PerfPhaseCount; p++){
+        perfStats.current[p] += view.perfTotals[p] - simPerfCounted[p];
+        simPerfCounted[p] = view.perfTotals[p];
+    }
+}
 
-    // dont need the original trexture, release memory
-    SDL_FreeSurface(surface);
-    return texture;
+// true if the window is on screen and gets the keyboard
+bool WindowActive(){
+    Uint32 flags = SDL_GetWindowFlags(window);
+    return (flags & SDL_WINDOW_INPUT_FOCUS) && !(flags & SDL_WINDOW_MINIMIZED);
+}
+
+// sleeps in SDL_WaitEventTimeout until the game should run again, nothing on
+// screen changes meanwhile so it only redraws when the window asks for it
+// paused ends on p, unfocused once the window is restored and focused again
+// false if the window was closed meanwhile
+bool IdleUntilResumed(IdleReason reason){
+    SDL_Event event;
+    for(;;){
+        if(!SDL_WaitEventTimeout(&event, idleTimeoutMs)) continue;
+
+        if(event.type == SDL_QUIT)
+            return false;
+        if(event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_p && reason == IdlePaused)
+            return true;
+        if(HandleRenderReset(event)){
+            Render();
+            continue;
+        }
+        if(event.type == SDL_WINDOWEVENT){
+            switch(event.window.event){
+                case SDL_WINDOWEVENT_EXPOSED:
+                    Render();
+                    break;
+                case SDL_WINDOWEVENT_FOCUS_GAINED:
+                case SDL_WINDOWEVENT_RESTORED:
+                    if(reason == IdleUnfocused && WindowActive())
+                        return true;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+// SDL_PollEvent counted as the event phase of the frame
+bool PollEvent(SDL_Event &event){
+    PERF_SCOPE(PerfEvents);
+    return SDL_PollEvent(&event);
+}
+
+// render targets lose their pixels on these, so the static layer is marked
+// to be drawn again, every loop that waits on events passes them through here
+// a device reset loses every texture, so those are made again too
+// true if event was one of them
+bool HandleRenderReset(const SDL_Event &event){
+    if(event.type == SDL_RENDER_DEVICE_RESET){
+        if(staticLayer != NULL)
+            SDL_DestroyTexture(staticLayer);
+        staticLayer = NULL;
+        ReloadAtlas();
+    }
+    if(event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET
+       || (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)){
+        staticLayerLevel = -1;
+        return true;
+    }
+    return false;
 }
 
 // renderes all the objects to the screen so the game can run (called every loop iteration)
+// from the newest snapshot, game itself belongs to the simulation thread
 void Render(){
+    {
+        PERF_SCOPE(PerfRender);
+        const Snapshot &view = LatestSnapshot(snapshots);
+        DrawScene(view);
+#ifdef FROGGER_PERF
+        if(showPerf)
+            DrawPerfOverlay(view);
+#endif
+    }
+    
+    // render the changes above
+    PERF_SCOPE(PerfPresent);
+    SDL_RenderPresent(renderer);
+}
+
+// draws the background, lanes and player without presenting them
+void DrawScene(const Snapshot &view){
+    DrawStaticLayer(view);
+
+    // everything comes from the atlas so the texture never changes
+    for(int a = 0; a < ArchetypeCount; a++){
+        const SDL_Rect *sprite = SpriteRect(atlas, archetypes[a].sprite);
+        for(const Rect &pos : view.objects[a])
+            SDL_RenderCopy(renderer, atlas.texture, sprite, ToSDLRect(pos));
+    }
+
+    SDL_RenderCopy(renderer, atlas.texture, SpriteRect(atlas, SpriteFrog), ToSDLRect(view.player));
+}
+
+// background and bars as one opaque copy, they only change with the level
+// falls back to drawing them one by one without render target support
+void DrawStaticLayer(const Snapshot &view){
+    if(staticLayerLevel != view.level && BuildStaticLayer(view))
+        staticLayerLevel = view.level;
+
+    if(staticLayer != NULL && staticLayerLevel == view.level){
+        // covers the whole window so there is nothing to clear
+        SDL_RenderCopy(renderer, staticLayer, NULL, NULL);
+        return;
+    }
+
     // Clear the window and make it red
     SDL_RenderClear(renderer);
+    DrawBackgroundAndBars(view);
+}
 
-    SDL_RenderCopy(renderer, backgroundTexture, NULL, &backgroundPos);
-    SDL_RenderCopy(renderer, barTexture, NULL, &topBar);
-    SDL_RenderCopy(renderer, barTexture, NULL, &bottomBar);
-    for(const auto &p : enemies)
-        SDL_RenderCopy(renderer, enemyTexture, NULL, &p.pos);
-    for(const auto &p : logs)
-        SDL_RenderCopy(renderer, logTexture, NULL, &p.pos);
+// composites the background and both bars into staticLayer
+// false if the renderer can't draw into textures
+bool BuildStaticLayer(const Snapshot &view){
+    if(staticLayer == NULL){
+        SDL_RendererInfo info;
+        if(SDL_GetRendererInfo(renderer, &info) != 0 || !(info.flags & SDL_RENDERER_TARGETTEXTURE))
+            return false;
+        staticLayer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                        windowRect.w, windowRect.h);
+        if(staticLayer == NULL) return false;
+        // opaque, so copying it never has to blend
+        SDL_SetTextureBlendMode(staticLayer, SDL_BLENDMODE_NONE);
+    }
 
-    SDL_RenderCopy(renderer, playerTexture, NULL, &playerPos);
-    
-    // render the changes above
-    SDL_RenderPresent(renderer);
+    if(SDL_SetRenderTarget(renderer, staticLayer) != 0) return false;
+    SDL_RenderClear(renderer);
+    DrawBackgroundAndBars(view);
+    SDL_SetRenderTarget(renderer, NULL);
+    return true;
+}
+
+// the parts of the screen that don't move
+void DrawBackgroundAndBars(const Snapshot &view){
+    SDL_RenderCopy(renderer, atlas.texture, SpriteRect(atlas, SpriteBackground), &backgroundPos);
+    SDL_RenderCopy(renderer, atlas.texture, SpriteRect(atlas, SpriteBar), ToSDLRect(view.topBar));
+    SDL_RenderCopy(renderer, atlas.texture, SpriteRect(atlas, SpriteBar), ToSDLRect(view.bottomBar));
+}
+
+// colors of the phases in the overlay
+const SDL_Color perfColors[PerfPhaseCount] = {
+    {255, 255, 0, 255},   // events
+    {0, 255, 0, 255},     // movement
+    {0, 255, 255, 255},   // collision
+    {80, 120, 255, 255},  // render
+    {255, 0, 255, 255},   // present
+    {160, 160, 160, 255}  // delay
+};
+
+// 3x5 pixel digits, one row of 3 bits per entry, high bit on the left
+const int digitRows[10][5] = {
+    {7, 5, 5, 5, 7}, {2, 6, 2, 2, 7}, {7, 1, 7, 4, 7}, {7, 1, 7, 1, 7}, {5, 5, 7, 1, 1},
+    {7, 4, 7, 1, 7}, {7, 4, 7, 5, 7}, {7, 1, 1, 1, 1}, {7, 5, 7, 5, 7}, {7, 5, 7, 1, 7}
+};
+
+// draws a number right aligned to x with the current draw color, 2px per font pixel
+void DrawNumber(int value, int x, int y){
+    SDL_Rect pixels[15 * 6];
+    int count = 0;
+    if(value < 0) value = 0;
+    do{
+        x -= 8;
+        const int *rows = digitRows[value % 10];
+        for(int r = 0; r < 5; r++)
+            for(int c = 0; c < 3; c++)
+                if(rows[r] & (4 >> c)){
+                    SDL_Rect pixel = {x + 2 * c, y + 2 * r, 2, 2};
+                    pixels[count++] = pixel;
+                }
+        value /= 10;
+    }while(value > 0 && count < 15 * 5);
+    SDL_RenderFillRects(renderer, pixels, count);
+}
+
+// one row per phase: a graph of the last frames and p50, p99 in microseconds
+// graphs are scaled so a full row is one 60Hz frame
+void DrawPerfOverlay(const Snapshot &view){
+    const int rowHeight = 14;
+    const int graphHeight = 12;
+    const float frameMicros = 1000000.0f / ticksPerSecond;
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 170);
+    SDL_Rect box = {0, view.topBar.h, windowRect.w, PerfPhaseCount * rowHeight + 4};
+    SDL_RenderFillRect(renderer, &box);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    SDL_Rect bars[perfHistory];
+    for(int p = 0; p < PerfPhaseCount; p++){
+        PerfPhase phase = (PerfPhase)p;
+        int top = box.y + 2 + p * rowHeight;
+        SDL_SetRenderDrawColor(renderer, perfColors[p].r, perfColors[p].g, perfColors[p].b, 255);
+
+        // newest frame on the right
+        int count = 0;
+        for(int age = 0; age < perfHistory; age++){
+            int h = PerfSample(phase, age) * graphHeight / frameMicros + 0.5f;
+            if(h <= 0) continue;
+            if(h > graphHeight) h = graphHeight;
+            SDL_Rect bar = {4 + perfHistory - 1 - age, top + graphHeight - h, 1, h};
+            bars[count++] = bar;
+        }
+        SDL_RenderFillRects(renderer, bars, count);
+
+        float p50, p99;
+        PerfPercentiles(phase, p50, p99);
+        DrawNumber(p50 + 0.5f, windowRect.w - 60, top + 1);
+        DrawNumber(p99 + 0.5f, windowRect.w - 8, top + 1);
+    }
+
+    // back to the clear color
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
 }
 
 // false if something does not initialize correctly
@@ -337,8 +1089,9 @@ bool CreateWindow(){
 }
 
 // helper to create renderer (false if can't create)
+// asks for vsync unless a frame rate was given, SDL goes without if it can't
 bool CreateRenderer(){
-    renderer = SDL_CreateRenderer(window, -1, 0);
+    renderer = SDL_CreateRenderer(window, -1, frameRate > 0 ? 0 : SDL_RENDERER_PRESENTVSYNC);
     if(renderer == nullptr){
         std::cout << "Failed to create renderer : " << SDL_GetError();
         return false;
@@ -355,189 +1108,73 @@ void SetupRenderer(){
     SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
 }
 
-// moves eveyr log on the screen according to their direction and speed
-void MoveLogs(){
-    for(auto &p : logs){
-        if(p.dir == Direction::Right){
-            p.pos.x += p.speed;
-
-            if(p.pos.x >= windowRect.w)
-                p.pos.x = 0;
-        }
-        else{
-            p.pos.x -= p.speed;
-
-            if((p.pos.x + p.pos.w) <= 0)
-                p.pos.x = windowRect.w -p.pos.w;
-        }
-    }
-}
-
-// moves every enemy according to their direction and speed
-void MoveEnemies(){
-    for(auto &p : enemies){
-        if(p.dir == Direction::Right){
-            p.pos.x += p.speed;
-
-            if(p.pos.x >= windowRect.w)
-                p.pos.x = 0;
-        }
-        else{
-            p.pos.x -= p.speed;
-
-            if((p.pos.x + p.pos.w) <= 0)
-                p.pos.x = windowRect.w -p.pos.w;
-        }
-    }
-}
-
-// checks for a general collision given two objects (all objects are rectangles)
-// true if collision, false otherwise
-bool CheckCollision(const SDL_Rect &rect1, const SDL_Rect &rect2){
-    // find edges of rect1 and rect2
-
-    int left1 = rect1.x;
-    int right1 = rect1.x + rect1.w;
-    int top1 = rect1.y;
-    int bottom1 = rect1.y + rect1.h;
-
-    int left2 = rect2.x;
-    int right2 = rect2.x + rect2.w;
-    int top2 = rect2.y;
-    int bottom2 = rect2.y + rect2.h;
-
-    // check edges
-    if(left1 > right2) return false; // left 1 is right of right 2
-    if(right1 < left2) return false;
-    if(top1 > bottom2) return false;
-    if(bottom1 < top2) return false;
-
-    return true;
-}
-
-// speciifcally checks if log opbjects collide with player
-// true if they do, false otherwise
-bool CheckLogCollisions(){
-    for(const auto &p : logs){
-        if(CheckCollision(p.pos, playerPos))
-            return true;
-    }
-
-    return false;
-
-}
-
-// returns a pointer to the log that player collides with
-Log * getLog(){
-    for(auto &p : logs){
-        if(CheckCollision(p.pos, playerPos))
-            return &p;
-    }
-    return NULL;
-
-}
-
-// spcifically checks if trucks collide with player
-// true if they collide, false otherwise
-bool CheckEnemyCollisions(){
-    for(const auto &p : enemies){
-        if(CheckCollision(p.pos, playerPos))
-            return true;
-    }
-
-    return false;
-
-}
-
-// Adds 3 enemies to a spciifc row
-// row is determined by value of lastEnemyPos variable
-void AddEnemy(){
-    int speed = rand() % 3 + 1;
-    // used to make random between left and right direciton
-    if((rand() % 2 ) == 0){
-        enemies.push_back(Enemy({rand() % 100, lastEnemyPos, 20, 20}, speed, Direction::Right));
-        enemies.push_back(Enemy({rand() % 100 + 75, lastEnemyPos, 20, 20}, speed, Direction::Right));
-        enemies.push_back(Enemy({rand() % 100 + 175, lastEnemyPos, 20, 20}, speed, Direction::Right));
-    }
-    else{
-        enemies.push_back(Enemy({rand() % 100, lastEnemyPos, 20, 20}, speed, Direction::Left));
-        enemies.push_back(Enemy({rand() % 100 + 75, lastEnemyPos, 20, 20}, speed, Direction::Left));
-        enemies.push_back(Enemy({rand() % 100 + 175, lastEnemyPos, 20, 20}, speed, Direction::Left));
-    }
-    lastEnemyPos += 25; // so next set of enemies is on the next row
-}
-
-// Adds 1 long log and 1 short log to specific row
-// row is determined by values of lastEnemyPos variable
-// takes if direction to make sure they move in opposite directions when called in other functions
-void AddLog(Direction dir){
-    int speed = rand() % 3 + 1; // rand spped for entire row
-    logs.push_back(Log({rand() % 100, lastEnemyPos, 40, 20}, speed, dir));
-    logs.push_back(Log({rand() % 100 + 175, lastEnemyPos, 20, 20}, speed, dir));
-    lastEnemyPos += 25; // so the next set of logs is on the next row
-}
-
-// adds enough objects ot fill the screen
-void addEnemies(){
-    // alternate left and right direction so player can always cross
-    AddLog(Right);
-    AddLog(Left);
-    AddLog(Right);
-    AddLog(Left);
-    AddLog(Right);
-    AddLog(Left);
-    AddLog(Right);
-    lastEnemyPos+=50; // skip green grass in middle
-    AddEnemy();
-    AddEnemy();
-    AddEnemy();
-    AddEnemy();
-    AddEnemy();
-    AddEnemy();
-    AddEnemy();
-}
-
-// puts the player on bottom of map
-void ResetPlayerPos(){
-    playerPos.x = (windowRect.w /2) - (playerPos.w /2);
-    playerPos.y = windowRect.h - bottomBar.h;
-}
-
 // displays game Over screen with player options
-// happens when player dies
-void gameOver(){
+// happens when player dies, returns Playing after a restart and Quit otherwise
+GameState gameOver(){
+    // the screen is drawn from the atlas, every game over is a cache hit
+    TextureHandle screen = AcquireTexture(textures, atlasKey);
 
     // render the game over screen
-    bool dead = true;
-    while(dead){
-        SDL_RenderClear(renderer);
-        SDL_Texture * curr = LoadTexture("img/gameOver.png");
-        SDL_RenderCopy(renderer, curr, NULL, &backgroundPos);
-        SDL_RenderPresent(renderer);
+    GameState next = GameOver;
+    bool redraw = true;
+    while(next == GameOver){
+        if(redraw){
+            SDL_RenderClear(renderer);
+            SDL_RenderCopy(renderer, GetTexture(textures, screen), SpriteRect(atlas, SpriteGameOver), &backgroundPos);
+            SDL_RenderPresent(renderer);
+            redraw = false;
+        }
         SDL_Event event;
+
+        // a replay restarts or quits on its own after showing the screen a moment
+        if(replaying){
+            ReplayEvent control;
+            SDL_Delay(1000 / replaySpeed);
+            next = Quit;
+            while(NextControlEvent(replay, replayTick, control)){
+                if(control.type == ReplayRestart){
+                    next = Playing;
+                    break;
+                }
+                if(control.type == ReplayQuit)
+                    break;
+            }
+            continue;
+        }
         
+        // nothing moves on this screen, sleep until there is input
+        if(!SDL_WaitEventTimeout(&event, idleTimeoutMs)) continue;
+
         // take in user input
-        while(SDL_PollEvent(&event)){
-            if(event.type == SDL_QUIT)
-                return;
+        do{
+            if(event.type == SDL_QUIT){
+                Record(ReplayQuit);
+                next = Quit;
+            }
             else if(event.type == SDL_KEYDOWN){
                 switch(event.key.keysym.sym){
                     /* implement restart */
                     case SDLK_r:
-                        logs.clear();
-                        enemies.clear();
-                        lastEnemyPos = 50;
-                        dead = false;
-                        loadObjects(false);
-                        RunGame();
+                        Record(ReplayRestart);
+                        next = Playing;
                         break;
                     case SDLK_q:
-                        dead = false;
+                        Record(ReplayQuit);
+                        next = Quit;
                         break;
                     default:
                         break;
                 }
             }
-        }
+            else if(HandleRenderReset(event)
+                    || (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_EXPOSED))
+                redraw = true;
+        }while(next == GameOver && SDL_PollEvent(&event));
     }
+    ReleaseTexture(textures, screen);
+
+    // a restart is a new session so it gets new lanes, in the same storage
+    if(next == Playing)
+        ResetGame(game);
+    return next;
 }
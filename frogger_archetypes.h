@@ -0,0 +1,58 @@
+// kinds of lane objects and the components all objects of a kind share
+// per object components (position, width, velocity, lane) are the Lanes
+// arrays, one Lanes per archetype indexed by ArchetypeId, systems loop over
+// archetypes instead of naming enemies and logs
+// a new kind of object is a table entry plus the spawner that places it
+
+#ifndef FROGGER_ARCHETYPES_H
+#define FROGGER_ARCHETYPES_H
+
+#include "frogger_lanes.h"
+#include "frogger_sprites.h"
+
+enum ArchetypeId{
+    EnemyArchetype,
+    LogArchetype,
+    ArchetypeCount
+};
+
+// what touching an object does to the player
+enum Behavior{
+    Lethal = 1,   // player dies
+    Rideable = 2  // player moves along with it and is safe on water
+};
+
+struct Archetype{
+    const char *name;
+    unsigned behavior; // Behavior flags
+    SpriteId sprite;   // drawn stretched over the object
+};
+
+// indexed by ArchetypeId, the order systems visit archetypes in
+const Archetype archetypes[ArchetypeCount] = {
+    {"enemy", Lethal, SpriteTruck},
+    {"log", Rideable, SpriteLogLong}
+};
+
+// object index of one archetype's lanes, index -1 for none
+struct ObjectIndex{
+    ArchetypeId archetype;
+    int index;
+};
+
+// the same by handle, so it survives objects moving in the arrays
+struct ObjectHandle{
+    ArchetypeId archetype;
+    LaneHandle handle;
+};
+
+const ObjectIndex noObject = {EnemyArchetype, -1};
+const ObjectHandle noObjectHandle = {EnemyArchetype, noLane};
+
+// true if object i of archetype is ridden before ride when both are under
+// the player, the first archetype in table order wins, then the lowest index
+inline bool RidesBefore(ArchetypeId archetype, int i, const ObjectIndex &ride){
+    return ride.index < 0 || archetype < ride.archetype || (archetype == ride.archetype && i < ride.index);
+}
+
+#endif
@@ -0,0 +1,138 @@
+// baked sprite atlas, made offline by frogger_pack (make pack)
+
+#include "frogger_assetpack.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+
+// size and modification time of a sprite's source file, false if it can't be read
+static bool SourceStamp(const char *file, uint32_t &size, int64_t &mtime){
+    struct stat info;
+    if(stat(file, &info) != 0) return false;
+    size = info.st_size;
+    mtime = info.st_mtime;
+    return true;
+}
+
+// writes the index and the sheet pixels, sheet must be in assetPackFormat
+bool WriteAssetPack(const std::string &path, const Atlas &atlas, SDL_Surface *sheet){
+    PackHeader header;
+    memcpy(header.magic, "FPAK", 4);
+    header.version = assetPackVersion;
+    header.format = assetPackFormat;
+    header.width = sheet->w;
+    header.height = sheet->h;
+    header.pitch = sheet->pitch;
+    header.spriteCount = SpriteCount;
+    size_t indexEnd = sizeof(PackHeader) + SpriteCount * sizeof(PackSprite);
+    header.pixelOffset = (indexEnd + 63) / 64 * 64;
+
+    std::vector<PackSprite> sprites(SpriteCount);
+    for(int i = 0; i < SpriteCount; i++){
+        PackSprite &sprite = sprites[i];
+        memset(&sprite, 0, sizeof(sprite));
+        sprite.id = i;
+        sprite.x = atlas.sprites[i].x;
+        sprite.y = atlas.sprites[i].y;
+        sprite.w = atlas.sprites[i].w;
+        sprite.h = atlas.sprites[i].h;
+        strncpy(sprite.file, spriteFiles[i], sizeof(sprite.file) - 1);
+        if(!SourceStamp(spriteFiles[i], sprite.fileSize, sprite.fileMtime)) return false;
+    }
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if(file == NULL) return false;
+    std::vector<uint8_t> padding(header.pixelOffset - indexEnd, 0);
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(sprites.data(), sizeof(PackSprite), SpriteCount, file) == (size_t)SpriteCount
+        && fwrite(padding.data(), 1, padding.size(), file) == padding.size();
+
+    SDL_LockSurface(sheet);
+    written = written && fwrite(sheet->pixels, sheet->pitch, sheet->h, file) == (size_t)sheet->h;
+    SDL_UnlockSurface(sheet);
+    return fclose(file) == 0 && written;
+}
+
+// maps a pack and checks its header, size and sources
+// false if it is missing, broken or older than one of its sprites
+bool MapAssetPack(AssetPack &pack, const std::string &path){
+    pack.data = NULL;
+    pack.size = 0;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(PackHeader)){
+        close(fd);
+        return false;
+    }
+    void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED) return false;
+
+    pack.data = (const uint8_t *)mapped;
+    pack.size = info.st_size;
+    pack.header = (const PackHeader *)pack.data;
+    pack.sprites = (const PackSprite *)(pack.data + sizeof(PackHeader));
+    pack.pixels = pack.data + pack.header->pixelOffset;
+
+    const PackHeader &header = *pack.header;
+    bool valid = memcmp(header.magic, "FPAK", 4) == 0
+        && header.version == assetPackVersion
+        && header.spriteCount == SpriteCount
+        && header.pitch >= header.width * 4
+        && sizeof(PackHeader) + header.spriteCount * sizeof(PackSprite) <= header.pixelOffset
+        && (size_t)header.pixelOffset + (size_t)header.pitch * header.height <= pack.size;
+    if(!valid){
+        std::cout << path << " is not a usable asset pack, rebuild it with make pack" << std::endl;
+        UnmapAssetPack(pack);
+        return false;
+    }
+
+    // every sprite has to come from the same file, unchanged since it was packed
+    for(int i = 0; i < SpriteCount; i++){
+        const PackSprite &sprite = pack.sprites[i];
+        uint32_t size;
+        int64_t mtime;
+        if(sprite.id >= (uint32_t)SpriteCount || strncmp(sprite.file, spriteFiles[sprite.id], sizeof(sprite.file)) != 0
+           || !SourceStamp(spriteFiles[sprite.id], size, mtime) || size != sprite.fileSize || mtime != sprite.fileMtime){
+            std::cout << "asset pack is out of date, rebuild it with make pack" << std::endl;
+            UnmapAssetPack(pack);
+            return false;
+        }
+    }
+    return true;
+}
+
+void UnmapAssetPack(AssetPack &pack){
+    if(pack.data != NULL)
+        munmap((void *)pack.data, pack.size);
+    pack.data = NULL;
+    pack.size = 0;
+}
+
+// uploads the mapped sheet straight into a texture, no decoding or conversion
+bool AtlasFromPack(Atlas &atlas, SDL_Renderer *renderer, const AssetPack &pack){
+    const PackHeader &header = *pack.header;
+    for(int i = 0; i < SpriteCount; i++){
+        const PackSprite &sprite = pack.sprites[i];
+        SDL_Rect rect = {sprite.x, sprite.y, sprite.w, sprite.h};
+        atlas.sprites[sprite.id] = rect;
+    }
+    atlas.width = header.width;
+    atlas.height = header.height;
+
+    atlas.texture = SDL_CreateTexture(renderer, header.format, SDL_TEXTUREACCESS_STATIC, header.width, header.height);
+    if(atlas.texture == NULL){
+        std::cout << "Failed to create atlas texture : " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_UpdateTexture(atlas.texture, NULL, pack.pixels, header.pitch);
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
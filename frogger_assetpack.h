@@ -0,0 +1,65 @@
+// baked sprite atlas, made offline by frogger_pack (make pack)
+// the pack holds the atlas sheet already in the renderer's pixel format plus
+// an index of sprite rectangles, at startup it is mapped into memory and
+// uploaded as is, so there is no image decoding at all
+//
+// file layout, native byte order
+//   PackHeader
+//   PackSprite x spriteCount
+//   pixels at pixelOffset, height rows of pitch bytes
+
+#ifndef FROGGER_ASSETPACK_H
+#define FROGGER_ASSETPACK_H
+
+#include <SDL2/SDL.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "frogger_atlas.h"
+
+const uint32_t assetPackVersion = 3;
+
+// pixel format of the sheet, what the software renderer and most GPUs use
+const Uint32 assetPackFormat = SDL_PIXELFORMAT_ARGB8888;
+
+// where the pack is written and looked for
+const char * const assetPackPath = "img/sprites.pack";
+
+struct PackHeader{
+    char magic[4];        // "FPAK"
+    uint32_t version;
+    uint32_t format;      // SDL_PIXELFORMAT_*
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;       // bytes per row
+    uint32_t spriteCount;
+    uint32_t pixelOffset; // from the start of the file, 64 byte aligned
+};
+
+struct PackSprite{
+    uint32_t id;          // SpriteId
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+    char file[32];        // spriteFiles[id] when packed, catches a stale pack
+    uint32_t fileSize;    // size and modification time of file when packed,
+    int64_t fileMtime;    // a pack is stale once either changes
+};
+
+// a pack mapped read only into memory
+struct AssetPack{
+    const uint8_t *data;
+    size_t size;
+    const PackHeader *header;
+    const PackSprite *sprites;
+    const uint8_t *pixels;
+};
+
+// PROTOTYPES
+bool WriteAssetPack(const std::string &path, const Atlas &atlas, SDL_Surface *sheet);
+bool MapAssetPack(AssetPack &pack, const std::string &path);
+void UnmapAssetPack(AssetPack &pack);
+bool AtlasFromPack(Atlas &atlas, SDL_Renderer *renderer, const AssetPack &pack);
+
+#endif
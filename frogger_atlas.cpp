@@ -0,0 +1,194 @@
+// every sprite in img/ packed into one texture
+
+#include "frogger_atlas.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <iostream>
+
+const char * const spriteFiles[SpriteCount] = {
+    "img/background.bmp",
+    "img/bar.bmp",
+    "img/frog.png",
+    "img/truck.png",
+    "img/logLong.png",
+    "img/gameOver.png"
+};
+
+// widest atlas we make, every renderer SDL ships supports this
+const int atlasMaxWidth = 1024;
+
+// empty pixels around each sprite so scaled draws never pick up a neighbour
+const int atlasPadding = 1;
+
+// shelf packing, tallest sprites first, each shelf is as tall as its first sprite
+// fills atlas.sprites, atlas.width and atlas.height (a power of two)
+// false if a sprite is wider than atlasMaxWidth
+bool PackAtlas(Atlas &atlas, const int widths[SpriteCount], const int heights[SpriteCount]){
+    int order[SpriteCount];
+    for(int i = 0; i < SpriteCount; i++)
+        order[i] = i;
+    std::stable_sort(order, order + SpriteCount, [&](int a, int b){
+        return heights[a] > heights[b];
+    });
+
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+    int used = 0;
+    for(int k = 0; k < SpriteCount; k++){
+        int id = order[k];
+        int w = widths[id] + 2 * atlasPadding;
+        int h = heights[id] + 2 * atlasPadding;
+        if(w > atlasMaxWidth) return false;
+
+        // start a new shelf when this one is full
+        if(x + w > atlasMaxWidth){
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        if(shelfHeight == 0)
+            shelfHeight = h;
+
+        SDL_Rect rect = {x + atlasPadding, y + atlasPadding, widths[id], heights[id]};
+        atlas.sprites[id] = rect;
+        x += w;
+        used = std::max(used, x);
+    }
+
+    atlas.width = 1;
+    while(atlas.width < used) atlas.width *= 2;
+    atlas.height = 1;
+    while(atlas.height < y + shelfHeight) atlas.height *= 2;
+    return true;
+}
+
+// packs the surfaces and copies them into one sheet of the given pixel format
+// the surfaces stay owned by the caller, the sheet belongs to the caller too
+SDL_Surface * ComposeAtlas(Atlas &atlas, SDL_Surface * const surfaces[SpriteCount], Uint32 format){
+    int widths[SpriteCount];
+    int heights[SpriteCount];
+    for(int i = 0; i < SpriteCount; i++){
+        widths[i] = surfaces[i]->w;
+        heights[i] = surfaces[i]->h;
+    }
+    if(!PackAtlas(atlas, widths, heights)){
+        std::cout << "Sprites don't fit in a " << atlasMaxWidth << " wide atlas" << std::endl;
+        return NULL;
+    }
+
+    SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(0, atlas.width, atlas.height, 32, format);
+    if(sheet == NULL){
+        std::cout << "Failed to create atlas surface : " << SDL_GetError() << std::endl;
+        return NULL;
+    }
+    for(int i = 0; i < SpriteCount; i++){
+        // copy pixels and alpha as they are instead of blending onto the empty sheet
+        SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+        SDL_Rect dest = atlas.sprites[i];
+        SDL_BlitSurface(surfaces[i], NULL, sheet, &dest);
+    }
+    return sheet;
+}
+
+// composes the surfaces into one sheet and uploads it
+bool BuildAtlas(Atlas &atlas, SDL_Renderer *renderer, SDL_Surface * const surfaces[SpriteCount]){
+    SDL_Surface *sheet = ComposeAtlas(atlas, surfaces, SDL_PIXELFORMAT_RGBA32);
+    if(sheet == NULL) return false;
+
+    atlas.texture = SDL_CreateTextureFromSurface(renderer, sheet);
+    SDL_FreeSurface(sheet);
+    if(atlas.texture == NULL){
+        std::cout << "Failed to create atlas texture : " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+// worker loop, takes the next undecoded sprite until there are none left
+static void DecodeSprites(SpriteLoader *loader){
+    for(;;){
+        int id;
+        {
+            std::lock_guard<std::mutex> guard(loader->lock);
+            if(loader->next >= SpriteCount) return;
+            id = loader->next++;
+        }
+
+        // the PNG decoder was set up by InitSpriteDecoding before any worker
+        // started, after that IMG_Load only touches its own file and surface
+        SDL_Surface *surface = IMG_Load(spriteFiles[id]);
+        if(surface == NULL)
+            std::cout << "Failed to load " << spriteFiles[id] << " : " << SDL_GetError() << std::endl;
+
+        {
+            std::lock_guard<std::mutex> guard(loader->lock);
+            loader->surfaces[id] = surface;
+            loader->ready[id] = true;
+        }
+        loader->decoded.notify_all();
+    }
+}
+
+// sets up SDL_image's PNG decoder, call on the main thread before StartSpriteLoader
+// otherwise the first IMG_Load of every worker races to set it up at once
+bool InitSpriteDecoding(){
+    if((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0){
+        std::cout << "Failed to initialize SDL_image : " << SDL_GetError() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// starts decoding every sprite, one worker per core up to one per sprite
+void StartSpriteLoader(SpriteLoader &loader){
+    for(int i = 0; i < SpriteCount; i++){
+        loader.surfaces[i] = NULL;
+        loader.ready[i] = false;
+    }
+    loader.next = 0;
+
+    int threads = std::min<int>(SpriteCount, std::max(1u, std::thread::hardware_concurrency()));
+    for(int t = 0; t < threads; t++)
+        loader.workers.push_back(std::thread(DecodeSprites, &loader));
+}
+
+// blocks until one sprite is decoded, NULL if it failed to load
+// the loader keeps owning the surface
+SDL_Surface * WaitForSprite(SpriteLoader &loader, SpriteId id){
+    std::unique_lock<std::mutex> guard(loader.lock);
+    loader.decoded.wait(guard, [&]{ return loader.ready[id]; });
+    return loader.surfaces[id];
+}
+
+// waits for the rest of the sprites, builds the atlas and frees the surfaces
+bool FinishAtlas(Atlas &atlas, SDL_Renderer *renderer, SpriteLoader &loader){
+    bool loaded = true;
+    for(int i = 0; i < SpriteCount; i++)
+        if(WaitForSprite(loader, (SpriteId)i) == NULL)
+            loaded = false;
+
+    if(loaded)
+        loaded = BuildAtlas(atlas, renderer, loader.surfaces);
+    StopSpriteLoader(loader);
+    return loaded;
+}
+
+// joins the workers and frees whatever they decoded
+void StopSpriteLoader(SpriteLoader &loader){
+    {
+        // workers that haven't started a sprite yet stop right away
+        std::lock_guard<std::mutex> guard(loader.lock);
+        loader.next = SpriteCount;
+    }
+    for(auto &worker : loader.workers)
+        worker.join();
+    loader.workers.clear();
+
+    for(int i = 0; i < SpriteCount; i++){
+        if(loader.surfaces[i] != NULL)
+            SDL_FreeSurface(loader.surfaces[i]);
+        loader.surfaces[i] = NULL;
+    }
+}
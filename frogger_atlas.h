@@ -0,0 +1,51 @@
+// every sprite the game draws packed into one texture
+// the renderer draws the whole scene from a single texture and picks
+// sprites by their rectangle, so it never has to switch textures
+
+#ifndef FROGGER_ATLAS_H
+#define FROGGER_ATLAS_H
+
+#include <SDL2/SDL.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "frogger_sprites.h"
+
+// file of every sprite, indexed by SpriteId
+extern const char * const spriteFiles[SpriteCount];
+
+struct Atlas{
+    SDL_Texture *texture;
+    SDL_Rect sprites[SpriteCount]; // where each sprite sits in texture
+    int width;
+    int height;
+};
+
+// decodes spriteFiles on worker threads, only uploads happen on the render thread
+// sprites are handed out in SpriteId order so the background is ready first
+struct SpriteLoader{
+    SDL_Surface *surfaces[SpriteCount];
+    bool ready[SpriteCount];  // decode finished, surface may still be NULL on failure
+    int next;                 // next sprite a worker picks up
+    std::mutex lock;
+    std::condition_variable decoded;
+    std::vector<std::thread> workers;
+};
+
+// PROTOTYPES
+bool PackAtlas(Atlas &atlas, const int widths[SpriteCount], const int heights[SpriteCount]);
+SDL_Surface * ComposeAtlas(Atlas &atlas, SDL_Surface * const surfaces[SpriteCount], Uint32 format);
+bool BuildAtlas(Atlas &atlas, SDL_Renderer *renderer, SDL_Surface * const surfaces[SpriteCount]);
+bool InitSpriteDecoding();
+void StartSpriteLoader(SpriteLoader &loader);
+SDL_Surface * WaitForSprite(SpriteLoader &loader, SpriteId id);
+bool FinishAtlas(Atlas &atlas, SDL_Renderer *renderer, SpriteLoader &loader);
+void StopSpriteLoader(SpriteLoader &loader);
+
+// rectangle of a sprite inside atlas.texture
+inline const SDL_Rect * SpriteRect(const Atlas &atlas, SpriteId id){
+    return &atlas.sprites[id];
+}
+
+#endif
@@ -0,0 +1,296 @@
+// many training games stepped together
+
+#include "frogger_batch.h"
+#include <algorithm>
+
+// first game of thread t, runs are whole multiples of batchGameAlign
+static int RunStart(const BatchEnv &batch, int t){
+    int groups = (batch.count + batchGameAlign - 1) / batchGameAlign;
+    int start = (int)((long long)groups * t / batch.threads) * batchGameAlign;
+    return std::min(start, batch.count);
+}
+
+// grid row of a y coordinate, clamped to the board
+static int RowOf(const BatchEnv &batch, int y){
+    int row = y < 0 ? 0 : y / gridCellSize;
+    return std::min(row, (int)batch.rowLanes.size() - 1);
+}
+
+// calls visit with every lane touching rows y0 to y1, each lane once
+template<typename Visit>
+static void ForLanesIn(const BatchEnv &batch, int y0, int y1, Visit visit){
+    int row0 = RowOf(batch, y0);
+    int row1 = RowOf(batch, y1);
+    for(int row = row0; row <= row1; row++){
+        for(int l : batch.rowLanes[row]){
+            const BatchLane &lane = batch.lanes[l];
+            // a lane spanning several rows is only looked at once
+            if(row != std::max(RowOf(batch, lane.y), row0)) continue;
+            if(lane.y > y1 || lane.y + entityHeight < y0) continue;
+            visit(lane);
+        }
+    }
+}
+
+// writes the lanes of game g's level through addEnemies on a scratch game
+// so they come out exactly as a single game's would, sped up rows included
+static void Respawn(BatchEnv &batch, Game &scratch, int g){
+    for(int a = 0; a < ArchetypeCount; a++){
+        Lanes &lanes = scratch.lanes[a];
+        for(int j = 0; j < batch.objects[a]; j++)
+            lanes.vel[j] = batch.vel[a][j * batch.count + g];
+    }
+    scratch.seed = batch.seed[g];
+    scratch.session = 1; // what ResetEnv leaves a game at
+    scratch.level = batch.level[g];
+    addEnemies(scratch);
+
+    for(int a = 0; a < ArchetypeCount; a++){
+        const Lanes &lanes = scratch.lanes[a];
+        for(int j = 0; j < batch.objects[a]; j++){
+            batch.x[a][j * batch.count + g] = lanes.x[j];
+            batch.w[a][j * batch.count + g] = lanes.w[j];
+            batch.vel[a][j * batch.count + g] = lanes.vel[j];
+        }
+    }
+}
+
+// puts game g's player at the bottom, like ResetPlayerPos
+static void ResetPlayer(BatchEnv &batch, int g){
+    batch.playerX[g] = batch.shape.playerPos.x;
+    batch.playerY[g] = batch.shape.playerPos.y;
+    batch.rideCarry[g] = 0;
+    batch.ride[g] = noObject;
+    batch.bestY[g] = batch.playerY[g];
+}
+
+// starts game g's next episode with the next seed of its stream
+static void NewEpisode(BatchEnv &batch, Game &scratch, int g){
+    batch.seed[g] = NextRandom(batch.episodes[g]);
+    batch.level[g] = 0;
+    batch.episodeTicks[g] = 0;
+    Respawn(batch, scratch, g);
+    ResetPlayer(batch, g);
+}
+
+// what the player of game g at pos touches, same answer as ScanHits
+static PlayerHits FindHits(const BatchEnv &batch, int g, const Rect &pos){
+    PlayerHits hits = {false, noObject};
+    ForLanesIn(batch, pos.y, pos.y + pos.h, [&](const BatchLane &lane){
+        unsigned behavior = archetypes[lane.archetype].behavior;
+        const Fixed *x = batch.x[lane.archetype].data();
+        const Fixed *w = batch.w[lane.archetype].data();
+        for(int j = lane.first; j < lane.first + lane.count; j++){
+            Rect object = {FixedToInt(x[j * batch.count + g]), lane.y, FixedToInt(w[j * batch.count + g]), entityHeight};
+            if(!CheckCollision(object, pos)) continue;
+            if(behavior & Lethal)
+                hits.hitEnemy = true;
+            if((behavior & Rideable) && RidesBefore(lane.archetype, j, hits.ride)){
+                hits.ride.archetype = lane.archetype;
+                hits.ride.index = j;
+            }
+        }
+    });
+    return hits;
+}
+
+// same observation ObserveEnv makes of a single game
+static void Observe(const BatchEnv &batch, int g, EnvObservation &obs){
+    const Game &shape = batch.shape;
+    obs.playerX = batch.playerX[g];
+    obs.playerY = batch.playerY[g];
+    obs.onLog = batch.ride[g].index >= 0;
+    obs.level = batch.level[g];
+
+    int step = shape.movementFactor;
+    Rect probe = {obs.playerX - step * (envViewCols / 2), obs.playerY - step * (envViewRows / 2),
+                  shape.playerPos.w, shape.playerPos.h};
+    for(int r = 0; r < envViewRows; r++, probe.y += step){
+        unsigned char *flags = obs.view[r];
+        unsigned char water = probe.y < waterBottom && probe.y > waterTop ? envWater : 0;
+        for(int c = 0; c < envViewCols; c++)
+            flags[c] = water;
+
+        ForLanesIn(batch, probe.y, probe.y + probe.h, [&](const BatchLane &lane){
+            unsigned char behavior = archetypes[lane.archetype].behavior;
+            const Fixed *x = batch.x[lane.archetype].data();
+            const Fixed *w = batch.w[lane.archetype].data();
+            for(int j = lane.first; j < lane.first + lane.count; j++){
+                int left = FixedToInt(x[j * batch.count + g]) - probe.w;
+                int right = FixedToInt(x[j * batch.count + g]) + FixedToInt(w[j * batch.count + g]);
+                for(int c = 0, px = probe.x; c < envViewCols; c++, px += step)
+                    flags[c] |= behavior & -(unsigned char)(px >= left && px <= right);
+            }
+        });
+    }
+}
+
+// the rest of a StepEnv for game g once its lanes have moved
+// a finished episode is replaced by the next one right away
+static void StepGameOf(BatchEnv &batch, Game &scratch, int g, Action action){
+    const Game &shape = batch.shape;
+    Rect pos = {batch.playerX[g], batch.playerY[g], shape.playerPos.w, shape.playerPos.h};
+
+    // BeginTick and MovePlayer
+    ObjectIndex ride = batch.ride[g];
+    if(ride.index >= 0)
+        RideLog(pos, batch.rideCarry[g], batch.vel[ride.archetype][ride.index * batch.count + g]);
+    else
+        batch.rideCarry[g] = 0;
+    ApplyAction(pos, action, shape.movementFactor);
+
+    TickResult result = ApplyHits(shape, pos, FindHits(batch, g, pos), ride);
+    batch.ride[g] = ride;
+    batch.playerX[g] = pos.x;
+    batch.playerY[g] = pos.y;
+    batch.episodeTicks[g]++;
+
+    float reward = 0;
+    if(result == Dead)
+        reward = envDeathReward;
+    else if(result == LevelUp){
+        reward = envLevelReward;
+        batch.level[g]++;
+        Respawn(batch, scratch, g);
+        ResetPlayer(batch, g);
+    }
+    else if(pos.y < batch.bestY[g]){
+        reward = envRowReward * ((batch.bestY[g] - pos.y) / shape.movementFactor);
+        batch.bestY[g] = pos.y;
+    }
+
+    bool done = result == Dead || batch.episodeTicks[g] >= envEpisodeTicks;
+    if(done)
+        NewEpisode(batch, scratch, g);
+    batch.rewards[g] = reward;
+    batch.dones[g] = done;
+    Observe(batch, g, batch.obs[g]);
+}
+
+// one thread's share of a step, each object row of its games is moved in one
+// kernel call before the games are stepped one by one
+static void RunGames(BatchEnv &batch, int t){
+    int g0 = RunStart(batch, t);
+    int g1 = RunStart(batch, t + 1);
+    if(g0 >= g1) return;
+
+    for(int a = 0; a < ArchetypeCount; a++){
+        for(int j = 0; j < batch.objects[a]; j++){
+            size_t first = (size_t)j * batch.count + g0;
+            MoveObjects(&batch.x[a][first], &batch.w[a][first], &batch.vel[a][first], g1 - g0,
+                        batch.shape.windowRect.w);
+        }
+    }
+    for(int g = g0; g < g1; g++)
+        StepGameOf(batch, batch.scratch[t], g, batch.actions[g]);
+}
+
+// worker loop, runs its share of every step handed out until the batch stops
+static void BatchWorker(BatchEnv *batch, int t){
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> guard(batch->lock);
+    for(;;){
+        batch->wake.wait(guard, [&]{ return batch->stop || batch->step != seen; });
+        if(batch->stop) return;
+        seen = batch->step;
+
+        guard.unlock();
+        RunGames(*batch, t);
+        guard.lock();
+        if(--batch->busy == 0)
+            batch->finished.notify_one();
+    }
+}
+
+// sets up count games, each on its own stream of episode seeds, and starts
+// the workers, threads 0 uses every core
+void InitBatch(BatchEnv &batch, int count, uint64_t seed, int threads){
+    if(threads <= 0) threads = std::thread::hardware_concurrency();
+    int groups = (count + batchGameAlign - 1) / batchGameAlign;
+    batch.count = count;
+    batch.threads = std::max(1, std::min(threads, groups));
+
+    Game &shape = batch.shape;
+    InitGame(shape, envWidth, envHeight, seed);
+    batch.lanes.clear();
+    for(int a = 0; a < ArchetypeCount; a++){
+        const Lanes &lanes = shape.lanes[a];
+        batch.objects[a] = LanesSize(lanes);
+        for(int j = 0; j < batch.objects[a]; j++){
+            if(j == 0 || lanes.lane[j] != lanes.lane[j - 1]){
+                BatchLane lane = {(ArchetypeId)a, shape.laneY[lanes.lane[j]], j, 0};
+                batch.lanes.push_back(lane);
+            }
+            batch.lanes.back().count++;
+        }
+        batch.x[a].assign((size_t)batch.objects[a] * count, 0);
+        batch.w[a].assign((size_t)batch.objects[a] * count, 0);
+        batch.vel[a].assign((size_t)batch.objects[a] * count, 0);
+    }
+
+    batch.rowLanes.assign(shape.windowRect.h / gridCellSize + 1, std::vector<int>());
+    for(size_t l = 0; l < batch.lanes.size(); l++)
+        for(int row = RowOf(batch, batch.lanes[l].y); row <= RowOf(batch, batch.lanes[l].y + entityHeight); row++)
+            batch.rowLanes[row].push_back(l);
+
+    batch.playerX.assign(count, 0);
+    batch.playerY.assign(count, 0);
+    batch.rideCarry.assign(count, 0);
+    batch.ride.assign(count, noObject);
+    batch.level.assign(count, 0);
+    batch.bestY.assign(count, 0);
+    batch.episodeTicks.assign(count, 0);
+    batch.seed.assign(count, 0);
+    batch.episodes.resize(count);
+    batch.obs.resize(count);
+    batch.rewards.assign(count, 0);
+    batch.dones.assign(count, 0);
+    batch.scratch.assign(batch.threads, shape);
+
+    Rng streams = MakeRng(seed, EnvStreams);
+    for(int g = 0; g < count; g++){
+        batch.episodes[g] = SplitRng(streams, g);
+        NewEpisode(batch, batch.scratch[0], g);
+        Observe(batch, g, batch.obs[g]);
+    }
+
+    batch.step = 0;
+    batch.busy = 0;
+    batch.stop = false;
+    batch.actions = NULL;
+    for(int t = 1; t < batch.threads; t++)
+        batch.workers.push_back(std::thread(BatchWorker, &batch, t));
+}
+
+// runs one tick of every game, actions holds one action per game
+// the results are in obs, rewards and dones once this returns
+void StepBatch(BatchEnv &batch, const Action *actions){
+    batch.actions = actions;
+    if(batch.threads > 1){
+        {
+            std::lock_guard<std::mutex> guard(batch.lock);
+            batch.step++;
+            batch.busy = batch.threads - 1;
+        }
+        batch.wake.notify_all();
+    }
+
+    RunGames(batch, 0);
+
+    if(batch.threads > 1){
+        std::unique_lock<std::mutex> guard(batch.lock);
+        batch.finished.wait(guard, [&]{ return batch.busy == 0; });
+    }
+}
+
+// joins the workers, the games stay as they are
+void StopBatch(BatchEnv &batch){
+    {
+        std::lock_guard<std::mutex> guard(batch.lock);
+        batch.stop = true;
+    }
+    batch.wake.notify_all();
+    for(auto &worker : batch.workers)
+        worker.join();
+    batch.workers.clear();
+}
@@ -0,0 +1,75 @@
+// many training games stepped together
+// every game plays the random layout, so they all have the same objects per
+// row and their lanes can be stored interleaved: object j of game g sits at
+// j * count + g, and one kernel call moves object j of a whole run of games
+// games never share state, so the result doesn't depend on the thread count
+
+#ifndef FROGGER_BATCH_H
+#define FROGGER_BATCH_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "frogger_env.h"
+
+// threads split the games in runs of this many so no two write the same cache line
+const int batchGameAlign = 16;
+
+// one row of the layout every game shares
+struct BatchLane{
+    ArchetypeId archetype;
+    int y;
+    int first; // first object of the row, rows are contiguous
+    int count;
+};
+
+struct BatchEnv{
+    int count;   // games
+    int threads; // the caller's thread plus count - 1 workers
+    Game shape;  // the layout every game follows, rows and board size
+
+    std::vector<BatchLane> lanes;
+    std::vector<std::vector<int> > rowLanes; // grid row -> lanes crossing it, like Grid
+    int objects[ArchetypeCount]; // per game
+
+    // lanes of every game, interleaved by game
+    std::vector<Fixed> x[ArchetypeCount];
+    std::vector<Fixed> w[ArchetypeCount];
+    std::vector<Fixed> vel[ArchetypeCount];
+
+    // every game's player and episode, indexed by game
+    std::vector<int> playerX;
+    std::vector<int> playerY;
+    std::vector<Fixed> rideCarry;
+    std::vector<ObjectIndex> ride; // object ridden, index -1 if none
+    std::vector<int> level;
+    std::vector<int> bestY;
+    std::vector<unsigned long> episodeTicks;
+    std::vector<uint64_t> seed;  // of the episode being played
+    std::vector<Rng> episodes;   // seeds of the next episodes
+
+    // what the last step gave back, a finished game already shows its next episode
+    std::vector<EnvObservation> obs;
+    std::vector<float> rewards;
+    std::vector<unsigned char> dones;
+
+    // respawns run through the rules on one scratch game per thread
+    std::vector<Game> scratch;
+
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake;     // a step was handed out
+    std::condition_variable finished; // a worker is done with it
+    unsigned long step;               // counts steps handed out
+    int busy;                         // workers still on the current step
+    bool stop;
+    const Action *actions;            // of the current step, one per game
+};
+
+// PROTOTYPES
+void InitBatch(BatchEnv &batch, int count, uint64_t seed, int threads);
+void StepBatch(BatchEnv &batch, const Action *actions);
+void StopBatch(BatchEnv &batch);
+
+#endif
@@ -0,0 +1,175 @@
+// microbenchmarks of the simulation hot paths
+// every case runs over a range of entity counts and reports ns per entity
+// as percentiles over many samples, printed as JSON so runs can be diffed
+//
+// usage: frogger_bench [--samples N] [--max N] [--seed S]
+
+#include "frogger_sim.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <stdlib.h>
+
+// entity visits each sample aims for so small counts still take measurable time
+const size_t sampleWork = 1 << 20;
+
+// keeps results alive so the compiler can't drop the work
+volatile int sink;
+
+struct BenchCase{
+    std::string name;
+    // sets the case up for a game, then returns the work of one repetition
+    std::function<std::function<void()>(Game &game)> prepare;
+    bool scales; // false if the case always works on the normal 21 per kind
+};
+
+// a game with count enemies and count logs spread over the usual 14 lanes
+// the first 21 of each are the normal layout, the rest copy their lane and speed
+static void FillGame(Game &game, size_t count, uint64_t seed){
+    InitGame(game, 300, 500, seed);
+    Rng rng = MakeRng(seed, 0);
+    for(int a = 0; a < ArchetypeCount; a++){
+        Lanes &lanes = game.lanes[a];
+        size_t base = LanesSize(lanes);
+        ReserveLanes(lanes, std::max(count, maxLaneObjects));
+        for(size_t i = base; i < count; i++){
+            size_t from = i % base;
+            AddToLanes(lanes, ToFixed(RandomBelow(rng, game.windowRect.w)), lanes.w[from],
+                       lanes.vel[from], lanes.lane[from]);
+        }
+    }
+    RebuildGrid(game.grid, game);
+
+    // stand the player in the middle of the road
+    game.playerPos.y = game.laneY[10];
+}
+
+// stands the player on the grass between the water and the road where no
+// object ever is, so first hit scans run through every object
+static void StandOnGrass(Game &game){
+    game.playerPos.y = game.laneY[6] + entityHeight + 5;
+}
+
+static double Percentile(const std::vector<double> &sorted, double p){
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+// times one case at one entity count and prints its JSON object
+static void RunCase(const BenchCase &bench, size_t count, int samples, uint64_t seed, bool first){
+    Game game;
+    FillGame(game, count, seed);
+    std::function<void()> work = bench.prepare(game);
+
+    size_t reps = std::max<size_t>(1, sampleWork / count);
+    work(); // warm up caches and the lazy grid bins
+
+    std::vector<double> nsPerEntity;
+    for(int s = 0; s < samples; s++){
+        auto start = std::chrono::steady_clock::now();
+        for(size_t r = 0; r < reps; r++)
+            work();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        nsPerEntity.push_back(elapsed.count() / ((double)reps * count));
+    }
+    std::sort(nsPerEntity.begin(), nsPerEntity.end());
+
+    std::cout << (first ? "" : ",\n")
+              << "    {\"name\": \"" << bench.name << "\", \"entities\": " << count
+              << ", \"reps\": " << reps << ", \"ns_per_entity\": {"
+              << "\"min\": " << nsPerEntity.front()
+              << ", \"p50\": " << Percentile(nsPerEntity, 0.5)
+              << ", \"p90\": " << Percentile(nsPerEntity, 0.9)
+              << ", \"p99\": " << Percentile(nsPerEntity, 0.99)
+              << ", \"max\": " << nsPerEntity.back() << "}}";
+    std::cout.flush();
+}
+
+int main(int argc, char*args[]){
+    int samples = 31;
+    size_t maxCount = 1000000;
+    uint64_t seed = 1;
+    for(int i = 1; i < argc; i++){
+        std::string arg = args[i];
+        if(arg == "--samples" && i + 1 < argc)
+            samples = std::max(1, atoi(args[++i]));
+        else if(arg == "--max" && i + 1 < argc)
+            maxCount = strtoull(args[++i], NULL, 10);
+        else if(arg == "--seed" && i + 1 < argc)
+            seed = strtoull(args[++i], NULL, 10);
+        else{
+            std::cerr << "usage: " << args[0] << " [--samples N] [--max N] [--seed S]" << std::endl;
+            return 1;
+        }
+    }
+
+    // the level pool has to outlive the NextLevel case
+    LevelPool pool;
+
+    std::vector<BenchCase> cases;
+    cases.push_back(BenchCase{"MoveEnemies", [](Game &game){
+        return std::function<void()>([&game]{ MoveLanes(game.lanes[EnemyArchetype], game.windowRect.w); });
+    }, true});
+    cases.push_back(BenchCase{"MoveLogs", [](Game &game){
+        return std::function<void()>([&game]{ MoveLanes(game.lanes[LogArchetype], game.windowRect.w); });
+    }, true});
+    cases.push_back(BenchCase{"CheckCollision", [](Game &game){
+        return std::function<void()>([&game]{
+            int hits = 0;
+            const Lanes &enemies = game.lanes[EnemyArchetype];
+            for(size_t i = 0; i < LanesSize(enemies); i++)
+                hits += CheckCollision(EntityRect(game, enemies, i), game.playerPos);
+            sink = hits;
+        });
+    }, true});
+    cases.push_back(BenchCase{"CheckEnemyCollisions", [](Game &game){
+        StandOnGrass(game);
+        return std::function<void()>([&game]{ sink = CheckEnemyCollisions(game); });
+    }, true});
+    cases.push_back(BenchCase{"getLog", [](Game &game){
+        StandOnGrass(game);
+        return std::function<void()>([&game]{ sink = getLog(game); });
+    }, true});
+    // a new tick every repetition so the lazy x binning is part of the cost
+    cases.push_back(BenchCase{"QueryGrid", [](Game &game){
+        return std::function<void()>([&game]{
+            game.ticks++;
+            PlayerHits hits = QueryGrid(game.grid, game, game.playerPos);
+            sink = hits.hitEnemy + hits.ride.index;
+        });
+    }, true});
+    // level up into a pool level as big as the board, copies and rebins every lane
+    cases.push_back(BenchCase{"NextLevel", [&pool](Game &game){
+        pool.levels.assign(1, Level());
+        Level &level = pool.levels[0];
+        level.laneY = game.laneY;
+        for(int a = 0; a < ArchetypeCount; a++)
+            level.lanes[a] = game.lanes[a];
+        game.levelPool = &pool;
+        return std::function<void()>([&game]{ NextLevel(game); });
+    }, true});
+    // level up with random lanes, respawns the normal layout with faster speeds
+    cases.push_back(BenchCase{"NextLevelRandom", [](Game &game){
+        return std::function<void()>([&game]{ NextLevel(game); });
+    }, false});
+
+    std::vector<size_t> counts;
+    for(size_t count = 21; count < maxCount; count *= 10)
+        counts.push_back(count);
+    counts.push_back(maxCount);
+
+    std::cout << "{\n  \"samples\": " << samples << ",\n  \"seed\": " << seed
+              << ",\n  \"results\": [\n";
+    bool first = true;
+    for(const auto &bench : cases){
+        for(size_t count : counts){
+            if(!bench.scales && count != counts.front()) continue;
+            RunCase(bench, count, samples, seed, first);
+            first = false;
+        }
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+// reinforcement learning interface over one headless game
+
+#include "frogger_env.h"
+
+// sets the game up once, the env has to be reset before the first step
+void InitEnv(Env &env, const LevelPool *pool){
+    InitGame(env.game, envWidth, envHeight, 0, pool);
+    env.bestY = env.game.playerPos.y;
+    env.episodeTicks = 0;
+    env.done = true;
+}
+
+// starts an episode that only depends on seed
+EnvObservation ResetEnv(Env &env, uint64_t seed){
+    Game &game = env.game;
+    game.seed = seed;
+    game.session = 0;
+    ResetGame(game);
+
+    env.bestY = game.playerPos.y;
+    env.episodeTicks = 0;
+    env.done = false;
+
+    EnvObservation obs;
+    ObserveEnv(env, obs);
+    return obs;
+}
+
+// runs one tick with the given action
+// stepping a finished episode does nothing until it is reset
+EnvStep StepEnv(Env &env, Action action){
+    Game &game = env.game;
+    EnvStep step;
+    step.reward = 0;
+    step.result = Alive;
+    if(!env.done){
+        step.result = StepGame(game, action);
+        env.episodeTicks++;
+
+        if(step.result == Dead)
+            step.reward = envDeathReward;
+        else if(step.result == LevelUp){
+            step.reward = envLevelReward;
+            env.bestY = game.playerPos.y;
+        }
+        else if(game.playerPos.y < env.bestY){
+            step.reward = envRowReward * ((env.bestY - game.playerPos.y) / game.movementFactor);
+            env.bestY = game.playerPos.y;
+        }
+        env.done = step.result == Dead || env.episodeTicks >= envEpisodeTicks;
+    }
+    step.done = env.done;
+    ObserveEnv(env, step.obs);
+    return step;
+}
+
+// fills obs from the game as it is now
+void ObserveEnv(const Env &env, EnvObservation &obs){
+    const Game &game = env.game;
+    obs.playerX = game.playerPos.x;
+    obs.playerY = game.playerPos.y;
+    obs.onLog = RideIndex(game).index >= 0;
+    obs.level = game.level;
+
+    Rect probe = game.playerPos;
+    probe.x -= game.movementFactor * (envViewCols / 2);
+    probe.y -= game.movementFactor * (envViewRows / 2);
+    SampleGrid(game.grid, game, probe, game.movementFactor, envViewRows, envViewCols, obs.view[0]);
+    for(int r = 0; r < envViewRows; r++, probe.y += game.movementFactor){
+        if(probe.y < waterBottom && probe.y > waterTop)
+            for(int c = 0; c < envViewCols; c++)
+                obs.view[r][c] |= envWater;
+    }
+}
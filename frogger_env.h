@@ -0,0 +1,63 @@
+// reinforcement learning interface over one headless game
+// ResetEnv and StepEnv play by the same rules as the window and the headless
+// runner, nothing here needs SDL and a step never allocates
+
+#ifndef FROGGER_ENV_H
+#define FROGGER_ENV_H
+
+#include <stdint.h>
+#include "frogger_sim.h"
+
+// board the env plays on, the size of the game window
+const int envWidth = 300;
+const int envHeight = 500;
+
+// actions are the values of Action, NoAction and the four moves
+const int envActionCount = 5;
+
+// the view is the player's neighbourhood one move away in every direction,
+// rows go from above the player to below, columns from left to right
+const int envViewRows = 3;
+const int envViewCols = 3;
+
+// view flag of a spot in the water, besides Lethal and Rideable
+const unsigned char envWater = 4;
+
+// getting further up the board is what pays
+const float envRowReward = 1;     // every row above the highest one reached this level
+const float envLevelReward = 10;  // reaching the top bar
+const float envDeathReward = -10;
+
+// an episode the player survives ends after a minute of game time
+const unsigned long envEpisodeTicks = 60 * ticksPerSecond;
+
+struct EnvObservation{
+    int playerX;
+    int playerY;
+    int onLog;  // 1 if riding a log or other rideable object
+    int level;
+    unsigned char view[envViewRows][envViewCols]; // what the player would touch there
+};
+
+// what one step gave back
+struct EnvStep{
+    EnvObservation obs;
+    float reward;
+    bool done;          // reset before stepping again
+    TickResult result;
+};
+
+struct Env{
+    Game game;
+    int bestY;          // highest the player got this level, rows below it pay nothing
+    unsigned long episodeTicks;
+    bool done;
+};
+
+// PROTOTYPES
+void InitEnv(Env &env, const LevelPool *pool = NULL);
+EnvObservation ResetEnv(Env &env, uint64_t seed);
+EnvStep StepEnv(Env &env, Action action);
+void ObserveEnv(const Env &env, EnvObservation &obs);
+
+#endif
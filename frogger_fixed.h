@@ -0,0 +1,38 @@
+// 16.16 fixed point for sub pixel lane positions and speeds
+// plain integer math, so every compiler and CPU steps the lanes bit for bit
+// the same and the move kernels stay integer SIMD
+
+#ifndef FROGGER_FIXED_H
+#define FROGGER_FIXED_H
+
+#include <stdint.h>
+
+typedef int32_t Fixed;
+
+const int fixedShift = 16;
+const Fixed fixedOne = 1 << fixedShift;
+
+// windows up to 32767 pixels wide fit
+inline Fixed ToFixed(int pixels){
+    return pixels * fixedOne;
+}
+
+// rounds towards negative infinity, so a sub pixel step left still moves a pixel
+inline int FixedToInt(Fixed value){
+    return value >> fixedShift;
+}
+
+// the fraction of a pixel left over by FixedToInt, always positive
+inline Fixed FixedFraction(Fixed value){
+    return value & (fixedOne - 1);
+}
+
+inline Fixed FixedMul(Fixed a, Fixed b){
+    return (Fixed)(((int64_t)a * b) >> fixedShift);
+}
+
+inline double FixedToDouble(Fixed value){
+    return (double)value / fixedOne;
+}
+
+#endif
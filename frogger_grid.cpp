@@ -0,0 +1,225 @@
+// grid broadphase for the lanes
+// lane membership only changes when lanes are spawned, so RebuildGrid runs then
+// and the per tick work is binning the few lanes a query actually lands in
+
+#include "frogger_grid.h"
+#include "frogger_sim.h"
+
+static int FloorDiv(int a, int b){
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static int Clamp(int v, int lo, int hi){
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// grid cell of a coordinate, edges are inclusive to match CheckCollision
+static int ColOf(const Grid &grid, int x){
+    return Clamp(FloorDiv(x, gridCellSize), 0, grid.cols - 1);
+}
+
+static int RowOf(const Grid &grid, int y){
+    return Clamp(FloorDiv(y, gridCellSize), 0, grid.rows - 1);
+}
+
+// first and last x cell object i covers, in whole pixels like EntityRect
+static void ObjectCols(const Grid &grid, const Lanes &lanes, int i, int &col0, int &col1){
+    int x = FixedToInt(lanes.x[i]);
+    col0 = ColOf(grid, x);
+    col1 = ColOf(grid, x + FixedToInt(lanes.w[i]));
+}
+
+// adds a grid lane for every (row, archetype) pair found in lanes
+// grid lanes from the last rebuild are written over so their memory is reused
+static void AddGridLanes(Grid &grid, size_t &used, const Game &game, const Lanes &lanes, ArchetypeId archetype){
+    grid.laneToGrid.assign(game.laneY.size(), -1);
+    for(size_t i = 0; i < LanesSize(lanes); i++){
+        int lane = lanes.lane[i];
+        if(grid.laneToGrid[lane] < 0){
+            if(used == grid.lanes.size())
+                grid.lanes.push_back(GridLane());
+            GridLane &gridLane = grid.lanes[used];
+            gridLane.archetype = archetype;
+            gridLane.y = game.laneY[lane];
+            gridLane.row0 = RowOf(grid, game.laneY[lane]);
+            gridLane.row1 = RowOf(grid, game.laneY[lane] + entityHeight);
+            gridLane.members.clear();
+            gridLane.binned = false;
+            gridLane.binnedTick = 0;
+            grid.laneToGrid[lane] = used++;
+        }
+        grid.lanes[grid.laneToGrid[lane]].members.push_back(i);
+    }
+}
+
+// true if the rows and the lane of every object are what the grid was built for
+static bool SameLayout(const Grid &grid, const Game &game){
+    if(grid.cols != game.windowRect.w / gridCellSize + 1 || grid.rows != game.windowRect.h / gridCellSize + 1)
+        return false;
+    if(grid.builtLaneY != game.laneY) return false;
+    for(int a = 0; a < ArchetypeCount; a++)
+        if(grid.builtLane[a] != game.lanes[a].lane) return false;
+    return true;
+}
+
+// works out which lanes cross which rows, call after lanes are spawned
+// a respawn that kept the rows and the objects per row only makes the bins stale
+void RebuildGrid(Grid &grid, const Game &game){
+    if(!grid.lanes.empty() && SameLayout(grid, game)){
+        InvalidateGrid(grid);
+        return;
+    }
+    grid.cols = game.windowRect.w / gridCellSize + 1;
+    grid.rows = game.windowRect.h / gridCellSize + 1;
+    grid.builtLaneY = game.laneY;
+    for(int a = 0; a < ArchetypeCount; a++)
+        grid.builtLane[a] = game.lanes[a].lane;
+
+    size_t used = 0;
+    for(int a = 0; a < ArchetypeCount; a++)
+        AddGridLanes(grid, used, game, game.lanes[a], (ArchetypeId)a);
+    grid.lanes.resize(used);
+
+    grid.rowLanes.resize(grid.rows);
+    for(auto &row : grid.rowLanes)
+        row.clear();
+    for(size_t l = 0; l < grid.lanes.size(); l++)
+        for(int row = grid.lanes[l].row0; row <= grid.lanes[l].row1; row++)
+            grid.rowLanes[row].push_back(l);
+}
+
+// forces every lane to be binned again, for when objects jump without a tick
+void InvalidateGrid(Grid &grid){
+    for(auto &lane : grid.lanes)
+        lane.binned = false;
+}
+
+// counting sort of the lane members into x cells
+static void BinLane(GridLane &lane, const Grid &grid, const Lanes &lanes){
+    lane.cellStart.assign(grid.cols + 1, 0);
+    for(int i : lane.members){
+        int col0, col1;
+        ObjectCols(grid, lanes, i, col0, col1);
+        for(int col = col0; col <= col1; col++)
+            lane.cellStart[col + 1]++;
+    }
+    for(int c = 0; c < grid.cols; c++)
+        lane.cellStart[c + 1] += lane.cellStart[c];
+    lane.cellEntries.resize(lane.cellStart[grid.cols]);
+
+    // cellStart[c] is the write cursor while filling and is shifted back after
+    for(int i : lane.members){
+        int col0, col1;
+        ObjectCols(grid, lanes, i, col0, col1);
+        for(int col = col0; col <= col1; col++)
+            lane.cellEntries[lane.cellStart[col]++] = i;
+    }
+    for(int c = grid.cols; c > 0; c--)
+        lane.cellStart[c] = lane.cellStart[c - 1];
+    lane.cellStart[0] = 0;
+}
+
+// adds member i of lane to hits if it touches the player and matters for the answer
+static void CheckHit(PlayerHits &hits, const GridLane &lane, const Lanes &lanes, int i, const Rect &player){
+    unsigned behavior = archetypes[lane.archetype].behavior;
+    bool lethal = (behavior & Lethal) && !hits.hitEnemy;
+    bool ride = (behavior & Rideable) && RidesBefore(lane.archetype, i, hits.ride);
+    Rect object = {FixedToInt(lanes.x[i]), lane.y, FixedToInt(lanes.w[i]), entityHeight};
+    if((lethal || ride) && CheckCollision(object, player)){
+        if(lethal) hits.hitEnemy = true;
+        if(ride){
+            hits.ride.archetype = lane.archetype;
+            hits.ride.index = i;
+        }
+    }
+}
+
+// checks the player against the objects in the cells it overlaps only
+// gives the same answer as ScanHits
+PlayerHits QueryGrid(Grid &grid, const Game &game, const Rect &player){
+    PlayerHits hits = {false, noObject};
+    int row0 = RowOf(grid, player.y);
+    int row1 = RowOf(grid, player.y + player.h);
+    int col0 = ColOf(grid, player.x);
+    int col1 = ColOf(grid, player.x + player.w);
+
+    for(int row = row0; row <= row1; row++){
+        for(int l : grid.rowLanes[row]){
+            GridLane &lane = grid.lanes[l];
+            // a lane spanning several rows is only looked at once
+            if(row != (lane.row0 > row0 ? lane.row0 : row0)) continue;
+            // members all share the lane's y, so a lane that misses the player is skipped whole
+            if(lane.y > player.y + player.h || lane.y + entityHeight < player.y) continue;
+
+            const Lanes &lanes = game.lanes[lane.archetype];
+            if(lane.members.size() <= gridScanLimit){
+                for(int i : lane.members)
+                    CheckHit(hits, lane, lanes, i, player);
+                continue;
+            }
+            if(!lane.binned || lane.binnedTick != game.ticks){
+                BinLane(lane, grid, lanes);
+                lane.binned = true;
+                lane.binnedTick = game.ticks;
+            }
+
+            for(int c = col0; c <= col1; c++){
+                for(int e = lane.cellStart[c]; e < lane.cellStart[c + 1]; e++)
+                    CheckHit(hits, lane, lanes, lane.cellEntries[e], player);
+            }
+        }
+    }
+    return hits;
+}
+
+// behavior flags of the objects touching each rect of a rows by cols block,
+// the first at rect and the others step pixels apart to the right and down,
+// flags holds the block row by row, the lanes are read as they are and never
+// binned so the grid isn't touched
+void SampleGrid(const Grid &grid, const Game &game, const Rect &rect, int step, int rows, int cols, unsigned char *flags){
+    for(int k = 0; k < rows * cols; k++)
+        flags[k] = 0;
+    int bottom = rect.y + step * (rows - 1) + rect.h;
+    int row0 = RowOf(grid, rect.y);
+    int row1 = RowOf(grid, bottom);
+
+    for(int row = row0; row <= row1; row++){
+        for(int l : grid.rowLanes[row]){
+            const GridLane &lane = grid.lanes[l];
+            if(row != (lane.row0 > row0 ? lane.row0 : row0)) continue;
+            if(lane.y > bottom || lane.y + entityHeight < rect.y) continue;
+
+            // CheckCollision split in two, every member shares the lane's y so
+            // the rows of the block are compared once per lane and only the
+            // columns per object, without branches
+            const Lanes &lanes = game.lanes[lane.archetype];
+            unsigned char behavior = archetypes[lane.archetype].behavior;
+            for(int r = 0, y = rect.y; r < rows; r++, y += step){
+                if(lane.y > y + rect.h || lane.y + entityHeight < y) continue;
+                unsigned char *rowFlags = flags + r * cols;
+                for(int i : lane.members){
+                    int left = FixedToInt(lanes.x[i]) - rect.w;
+                    int right = FixedToInt(lanes.x[i]) + FixedToInt(lanes.w[i]);
+                    for(int c = 0, x = rect.x; c < cols; c++, x += step)
+                        rowFlags[c] |= behavior & -(unsigned char)(x >= left && x <= right);
+                }
+            }
+        }
+    }
+}
+
+// same answer as QueryGrid from one pass over every object
+PlayerHits ScanHits(const Game &game, const Rect &player){
+    PlayerHits hits = {false, noObject};
+    for(int a = 0; a < ArchetypeCount; a++){
+        int hit = FirstHit(game, game.lanes[a], player);
+        if(hit < 0) continue;
+        if(archetypes[a].behavior & Lethal)
+            hits.hitEnemy = true;
+        if((archetypes[a].behavior & Rideable) && RidesBefore((ArchetypeId)a, hit, hits.ride)){
+            hits.ride.archetype = (ArchetypeId)a;
+            hits.ride.index = hit;
+        }
+    }
+    return hits;
+}
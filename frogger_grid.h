@@ -0,0 +1,60 @@
+// uniform grid over the window so collision queries only look at nearby objects
+// rows are keyed on y and know which lanes cross them, the x cells of a lane
+// are binned again the first time the lane is queried in a tick, lanes with
+// only a few objects are scanned instead
+
+#ifndef FROGGER_GRID_H
+#define FROGGER_GRID_H
+
+#include <stddef.h>
+#include <vector>
+#include "frogger_archetypes.h"
+
+struct Game;
+struct Rect;
+
+// size of a grid cell in pixels, one row per lane
+const int gridCellSize = 25;
+
+// lanes with at most this many objects are checked one by one, binning them
+// every tick costs more than it saves
+const size_t gridScanLimit = 8;
+
+// every object of one archetype in one lane, binned by x cell
+// entries of cell c are cellEntries[cellStart[c]] up to cellEntries[cellStart[c + 1]]
+struct GridLane{
+    ArchetypeId archetype;
+    int y;                         // top of every member, in pixels
+    int row0;                      // first and last grid row the lane covers
+    int row1;
+    std::vector<int> members;      // indices into the archetype's lanes
+    bool binned;                   // true if the cells below match binnedTick
+    unsigned long binnedTick;
+    std::vector<int> cellStart;
+    std::vector<int> cellEntries;
+};
+
+struct Grid{
+    int cols;
+    int rows;
+    std::vector<GridLane> lanes;
+    std::vector<std::vector<int> > rowLanes; // grid row -> indices into lanes
+    std::vector<int> laneToGrid;             // scratch for RebuildGrid
+    std::vector<int> builtLaneY;             // layout the lanes were last built for
+    std::vector<int> builtLane[ArchetypeCount];
+};
+
+// what the player is touching after a query
+struct PlayerHits{
+    bool hitEnemy;
+    ObjectIndex ride; // rideable object under the player, see RidesBefore, index -1 if none
+};
+
+// PROTOTYPES
+void RebuildGrid(Grid &grid, const Game &game);
+void InvalidateGrid(Grid &grid);
+PlayerHits QueryGrid(Grid &grid, const Game &game, const Rect &player);
+PlayerHits ScanHits(const Game &game, const Rect &player);
+void SampleGrid(const Grid &grid, const Game &game, const Rect &rect, int step, int rows, int cols, unsigned char *flags);
+
+#endif
@@ -0,0 +1,48 @@
+// lock free single producer single consumer ring of key presses
+
+#include "frogger_input.h"
+
+// empties the ring, neither side may be using it meanwhile
+void InitInputRing(InputRing &ring){
+    ring.head.store(0);
+    ring.tail.store(0);
+}
+
+// producer side, false if the ring is full and the press was dropped
+bool PushInput(InputRing &ring, Action action, uint64_t time){
+    size_t tail = ring.tail.load(std::memory_order_relaxed);
+    if(tail - ring.head.load(std::memory_order_acquire) == inputRingSize)
+        return false;
+    TimedAction &slot = ring.slots[tail % inputRingSize];
+    slot.action = action;
+    slot.time = time;
+    ring.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+// consumer side, the oldest press without taking it, false if there is none
+bool PeekInput(InputRing &ring, TimedAction &input){
+    size_t head = ring.head.load(std::memory_order_relaxed);
+    if(head == ring.tail.load(std::memory_order_acquire))
+        return false;
+    input = ring.slots[head % inputRingSize];
+    return true;
+}
+
+// consumer side, drops the press PeekInput returned
+void PopInput(InputRing &ring){
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// consumer side, moves every press that arrived by time into actions in order
+// returns how many it took
+size_t TakeInputsUntil(InputRing &ring, uint64_t time, std::vector<Action> &actions){
+    size_t taken = 0;
+    TimedAction input;
+    while(PeekInput(ring, input) && input.time <= time){
+        actions.push_back(input.action);
+        PopInput(ring);
+        taken++;
+    }
+    return taken;
+}
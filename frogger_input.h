@@ -0,0 +1,36 @@
+// key presses on their way from the event pump to the simulation thread
+// one producer and one consumer, neither ever blocks the other
+// every press carries the time it arrived so the simulation can give it to
+// the tick whose time span it landed in instead of whichever tick runs next
+
+#ifndef FROGGER_INPUT_H
+#define FROGGER_INPUT_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "frogger_sim.h"
+
+// presses the ring holds before new ones are dropped, a power of two
+const size_t inputRingSize = 64;
+
+struct TimedAction{
+    Action action;
+    uint64_t time; // arrival on the producer's clock
+};
+
+struct InputRing{
+    TimedAction slots[inputRingSize];
+    std::atomic<size_t> head; // next press to read, only the consumer moves it
+    std::atomic<size_t> tail; // next free slot, only the producer moves it
+};
+
+// PROTOTYPES
+void InitInputRing(InputRing &ring);
+bool PushInput(InputRing &ring, Action action, uint64_t time);
+bool PeekInput(InputRing &ring, TimedAction &input);
+void PopInput(InputRing &ring);
+size_t TakeInputsUntil(InputRing &ring, uint64_t time, std::vector<Action> &actions);
+
+#endif
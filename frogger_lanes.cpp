@@ -0,0 +1,293 @@
+// bulk movement of lane objects
+// MoveLanes uses the widest kernel the CPU it runs on has
+
+#include "frogger_lanes.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(FROGGER_AVX2_KERNEL)
+#include <immintrin.h>
+#endif
+
+// fixes the most objects lanes can hold and allocates all of it now
+// so adding and removing objects never touches the heap afterwards
+void ReserveLanes(Lanes &lanes, size_t capacity){
+    lanes.capacity = capacity;
+    lanes.x.reserve(capacity);
+    lanes.w.reserve(capacity);
+    lanes.vel.reserve(capacity);
+    lanes.lane.reserve(capacity);
+    lanes.spawnX.reserve(capacity);
+    lanes.slotOf.reserve(capacity);
+    lanes.objectOf.reserve(capacity);
+    lanes.generation.reserve(capacity);
+    lanes.freeSlots.reserve(capacity);
+}
+
+// adds one object to the end of every array
+// returns noLane if the lanes are at their capacity
+LaneHandle AddToLanes(Lanes &lanes, Fixed x, Fixed w, Fixed vel, int lane){
+    size_t i = LanesSize(lanes);
+    if(lanes.capacity > 0 && i >= lanes.capacity) return noLane;
+
+    int slot;
+    if(!lanes.freeSlots.empty()){
+        slot = lanes.freeSlots.back();
+        lanes.freeSlots.pop_back();
+    }
+    else{
+        slot = lanes.objectOf.size();
+        lanes.objectOf.push_back(-1);
+        lanes.generation.push_back(0);
+    }
+    lanes.objectOf[slot] = i;
+
+    lanes.x.push_back(x);
+    lanes.w.push_back(w);
+    lanes.vel.push_back(vel);
+    lanes.lane.push_back(lane);
+    lanes.spawnX.push_back(x);
+    lanes.slotOf.push_back(slot);
+    LaneHandle handle = {slot, lanes.generation[slot]};
+    return handle;
+}
+
+// overwrites object i in place, or adds it when i is one past the end
+// it counts as a new object, handles to the old one go stale
+LaneHandle PutInLanes(Lanes &lanes, size_t i, Fixed x, Fixed w, Fixed vel, int lane){
+    if(i == LanesSize(lanes))
+        return AddToLanes(lanes, x, w, vel, lane);
+    lanes.x[i] = x;
+    lanes.w[i] = w;
+    lanes.vel[i] = vel;
+    lanes.lane[i] = lane;
+    lanes.spawnX[i] = x;
+
+    int slot = lanes.slotOf[i];
+    lanes.generation[slot]++;
+    LaneHandle handle = {slot, lanes.generation[slot]};
+    return handle;
+}
+
+// removes one object by moving the last object into its place
+// object indices change, so the grid has to be rebuilt afterwards
+// false if the handle was already stale
+bool RemoveFromLanes(Lanes &lanes, LaneHandle handle){
+    int i = LaneIndex(lanes, handle);
+    if(i < 0) return false;
+
+    size_t last = LanesSize(lanes) - 1;
+    lanes.x[i] = lanes.x[last];
+    lanes.w[i] = lanes.w[last];
+    lanes.vel[i] = lanes.vel[last];
+    lanes.lane[i] = lanes.lane[last];
+    lanes.spawnX[i] = lanes.spawnX[last];
+    lanes.slotOf[i] = lanes.slotOf[last];
+    lanes.objectOf[lanes.slotOf[i]] = i;
+
+    lanes.x.pop_back();
+    lanes.w.pop_back();
+    lanes.vel.pop_back();
+    lanes.lane.pop_back();
+    lanes.spawnX.pop_back();
+    lanes.slotOf.pop_back();
+
+    lanes.objectOf[handle.slot] = -1;
+    lanes.generation[handle.slot]++;
+    lanes.freeSlots.push_back(handle.slot);
+    return true;
+}
+
+// removes every object but keeps the memory around
+void ClearLanes(Lanes &lanes){
+    for(int slot : lanes.slotOf){
+        lanes.objectOf[slot] = -1;
+        lanes.generation[slot]++;
+        lanes.freeSlots.push_back(slot);
+    }
+    lanes.x.clear();
+    lanes.w.clear();
+    lanes.vel.clear();
+    lanes.lane.clear();
+    lanes.spawnX.clear();
+    lanes.slotOf.clear();
+}
+
+// replaces the objects of to with copies of the ones in from, in the same order
+// to keeps its own memory and capacity, objects past it are dropped
+void CopyLanes(Lanes &to, const Lanes &from){
+    ClearLanes(to);
+    for(size_t i = 0; i < LanesSize(from); i++){
+        if(AddToLanes(to, from.x[i], from.w[i], from.vel[i], from.lane[i]).slot < 0) break;
+        to.spawnX.back() = from.spawnX[i];
+    }
+}
+
+// where the object of a handle is now, -1 if the handle is stale
+int LaneIndex(const Lanes &lanes, LaneHandle handle){
+    if(handle.slot < 0 || handle.slot >= (int)lanes.objectOf.size()) return -1;
+    if(lanes.generation[handle.slot] != handle.generation) return -1;
+    return lanes.objectOf[handle.slot];
+}
+
+// handle of object i, noLane if i is -1
+LaneHandle LaneHandleOf(const Lanes &lanes, int i){
+    if(i < 0) return noLane;
+    int slot = lanes.slotOf[i];
+    LaneHandle handle = {slot, lanes.generation[slot]};
+    return handle;
+}
+
+size_t LanesSize(const Lanes &lanes){
+    return lanes.x.size();
+}
+
+// moves every object by its velocity and wraps it around the window
+// windowWidth is in pixels
+void MoveLanes(Lanes &lanes, int windowWidth){
+    size_t count = LanesSize(lanes);
+    if(count == 0) return;
+    MoveObjects(lanes.x.data(), lanes.w.data(), lanes.vel.data(), count, windowWidth);
+}
+
+// MoveLanes on bare arrays with the best kernel this CPU can run
+void MoveObjects(Fixed *x, const Fixed *w, const Fixed *vel, size_t count, int windowWidth){
+    Fixed width = ToFixed(windowWidth);
+#if defined(FROGGER_AVX2_KERNEL)
+    if(CpuHasAVX2()){
+        MoveLanesAVX2(x, w, vel, count, width);
+        return;
+    }
+#endif
+#if defined(__SSE2__)
+    MoveLanesSSE2(x, w, vel, count, width);
+#else
+    MoveLanesScalar(x, w, vel, count, width);
+#endif
+}
+
+// x of an object t ticks after it spawned, same as calling MoveLanes t times
+// after the first wrap an object cycles through ceil(windowWidth / speed) positions
+// so this is constant time no matter how big t is, all in fixed point
+Fixed PositionAt(Fixed spawnX, Fixed w, Fixed vel, unsigned long t, Fixed windowWidth){
+    if(vel == 0 || t == 0) return spawnX;
+
+    long long speed = vel > 0 ? vel : -vel;
+    long long period = (windowWidth + speed - 1) / speed;
+
+    // distance left before the first wrap and the tick it happens on
+    long long gap = vel > 0 ? (long long)windowWidth - spawnX : (long long)spawnX + w;
+    long long firstWrap = gap > 0 ? (gap + speed - 1) / speed : 1;
+
+    if((long long)t < firstWrap)
+        return spawnX + vel * (long long)t;
+
+    long long step = ((long long)t - firstWrap) % period;
+    if(vel > 0)
+        return step * speed;
+    return windowWidth - w - step * speed;
+}
+
+// puts every object where it is t ticks after spawning, windowWidth is in pixels
+void SeekLanes(Lanes &lanes, unsigned long t, int windowWidth){
+    Fixed width = ToFixed(windowWidth);
+    for(size_t i = 0; i < LanesSize(lanes); i++)
+        lanes.x[i] = PositionAt(lanes.spawnX[i], lanes.w[i], lanes.vel[i], t, width);
+}
+
+// one object at a time, also handles the tail of the SIMD kernels
+void MoveLanesScalar(int *x, const int *w, const int *vel, size_t count, int windowWidth){
+    for(size_t i = 0; i < count; i++){
+        int next = x[i] + vel[i];
+        bool right = vel[i] > 0;
+        bool wrapRight = right && next >= windowWidth;
+        bool wrapLeft = !right && next + w[i] <= 0;
+        next = wrapRight ? 0 : next;
+        x[i] = wrapLeft ? windowWidth - w[i] : next;
+    }
+}
+
+#if defined(__SSE2__)
+// where the 4 objects from i on move to, wraps are done with masks instead of branches
+static inline __m128i MoveFourSSE2(const int *x, const int *w, const int *vel, size_t i, __m128i width){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i px = _mm_loadu_si128((const __m128i *)(x + i));
+    __m128i pw = _mm_loadu_si128((const __m128i *)(w + i));
+    __m128i pv = _mm_loadu_si128((const __m128i *)(vel + i));
+
+    __m128i next = _mm_add_epi32(px, pv);
+    __m128i right = _mm_cmpgt_epi32(pv, zero);
+
+    // next >= windowWidth is next > windowWidth - 1
+    __m128i wrapRight = _mm_and_si128(right, _mm_cmpgt_epi32(next, _mm_sub_epi32(width, one)));
+    // next + w <= 0 is next + w < 1
+    __m128i wrapLeft = _mm_andnot_si128(right, _mm_cmplt_epi32(_mm_add_epi32(next, pw), one));
+
+    next = _mm_andnot_si128(wrapRight, next);
+    return _mm_or_si128(_mm_andnot_si128(wrapLeft, next),
+                        _mm_and_si128(wrapLeft, _mm_sub_epi32(width, pw)));
+}
+
+// 4 objects per step
+// the last 4 objects are moved from their old x before the loop and stored
+// after it, so a tail overlapping the loop needs no scalar pass
+void MoveLanesSSE2(int *x, const int *w, const int *vel, size_t count, int windowWidth){
+    if(count < 4){
+        MoveLanesScalar(x, w, vel, count, windowWidth);
+        return;
+    }
+    const __m128i width = _mm_set1_epi32(windowWidth);
+    __m128i tail = MoveFourSSE2(x, w, vel, count - 4, width);
+    for(size_t i = 0; i + 4 < count; i += 4)
+        _mm_storeu_si128((__m128i *)(x + i), MoveFourSSE2(x, w, vel, i, width));
+    _mm_storeu_si128((__m128i *)(x + count - 4), tail);
+}
+#endif
+
+#if defined(FROGGER_AVX2_KERNEL)
+// true if the CPU can run MoveLanesAVX2, asked once
+bool CpuHasAVX2(){
+    static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return avx2;
+}
+
+// where the 8 objects from i on move to, same masks as the SSE2 kernel
+__attribute__((target("avx2")))
+static inline __m256i MoveEightAVX2(const int *x, const int *w, const int *vel, size_t i, __m256i width){
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i px = _mm256_loadu_si256((const __m256i *)(x + i));
+    __m256i pw = _mm256_loadu_si256((const __m256i *)(w + i));
+    __m256i pv = _mm256_loadu_si256((const __m256i *)(vel + i));
+
+    __m256i next = _mm256_add_epi32(px, pv);
+    __m256i right = _mm256_cmpgt_epi32(pv, zero);
+
+    __m256i wrapRight = _mm256_and_si256(right, _mm256_cmpgt_epi32(next, _mm256_sub_epi32(width, one)));
+    __m256i wrapLeft = _mm256_andnot_si256(right, _mm256_cmpgt_epi32(one, _mm256_add_epi32(next, pw)));
+
+    next = _mm256_andnot_si256(wrapRight, next);
+    return _mm256_blendv_epi8(next, _mm256_sub_epi32(width, pw), wrapLeft);
+}
+
+// 8 objects per step, with the overlapping tail of the SSE2 kernel
+// compiled for AVX2 on its own so the rest of the build stays portable
+__attribute__((target("avx2")))
+void MoveLanesAVX2(int *x, const int *w, const int *vel, size_t count, int windowWidth){
+    if(count < 8){
+#if defined(__SSE2__)
+        MoveLanesSSE2(x, w, vel, count, windowWidth);
+#else
+        MoveLanesScalar(x, w, vel, count, windowWidth);
+#endif
+        return;
+    }
+    const __m256i width = _mm256_set1_epi32(windowWidth);
+    __m256i tail = MoveEightAVX2(x, w, vel, count - 8, width);
+    for(size_t i = 0; i + 8 < count; i += 8)
+        _mm256_storeu_si256((__m256i *)(x + i), MoveEightAVX2(x, w, vel, i, width));
+    _mm256_storeu_si256((__m256i *)(x + count - 8), tail);
+}
+#endif
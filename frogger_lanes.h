@@ -0,0 +1,75 @@
+// lane objects (logs and enemies) stored as parallel arrays
+// so whole lanes can be moved with SIMD and no per object branches
+
+#ifndef FROGGER_LANES_H
+#define FROGGER_LANES_H
+
+#include <vector>
+#include <stddef.h>
+#include "frogger_fixed.h"
+
+// x86 GCC and Clang builds always carry the AVX2 kernel, whatever -march says,
+// and MoveObjects only runs it on CPUs that have AVX2
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FROGGER_AVX2_KERNEL
+#endif
+
+// every object in a lane is this tall
+const int entityHeight = 20;
+
+// refers to one object no matter where it moves in the arrays
+// stale once the object is removed, cleared or written over
+struct LaneHandle{
+    int slot;            // -1 for no object
+    unsigned generation;
+};
+
+const LaneHandle noLane = {-1, 0};
+
+// one array per field, index i is the same object in all of them
+// x, w, vel and spawnX are 16.16 fixed point so lanes can move sub pixel speeds
+// objects stay packed at the front so whole arrays can be moved, handles
+// go through the slot tables to find where their object is now
+struct Lanes{
+    std::vector<Fixed> x;     // left edge
+    std::vector<Fixed> w;     // width
+    std::vector<Fixed> vel;   // per tick, positive moves right
+    std::vector<int> lane;    // which row the object is in
+    std::vector<Fixed> spawnX; // x when the level started, for PositionAt
+    std::vector<int> slotOf; // handle slot of every object
+
+    std::vector<int> objectOf;        // object of every handle slot, -1 if free
+    std::vector<unsigned> generation; // bumped whenever a slot's object goes away
+    std::vector<int> freeSlots;
+    size_t capacity = 0;              // most objects, 0 to grow as needed
+};
+
+// PROTOTYPES
+void ReserveLanes(Lanes &lanes, size_t capacity);
+LaneHandle AddToLanes(Lanes &lanes, Fixed x, Fixed w, Fixed vel, int lane);
+LaneHandle PutInLanes(Lanes &lanes, size_t i, Fixed x, Fixed w, Fixed vel, int lane);
+bool RemoveFromLanes(Lanes &lanes, LaneHandle handle);
+void ClearLanes(Lanes &lanes);
+void CopyLanes(Lanes &to, const Lanes &from);
+int LaneIndex(const Lanes &lanes, LaneHandle handle);
+LaneHandle LaneHandleOf(const Lanes &lanes, int i);
+size_t LanesSize(const Lanes &lanes);
+void MoveLanes(Lanes &lanes, int windowWidth);
+void MoveObjects(Fixed *x, const Fixed *w, const Fixed *vel, size_t count, int windowWidth);
+Fixed PositionAt(Fixed spawnX, Fixed w, Fixed vel, unsigned long t, Fixed windowWidth);
+void SeekLanes(Lanes &lanes, unsigned long t, int windowWidth);
+
+// kernels behind MoveLanes, they all give the same result
+// every argument is fixed point, windowWidth included
+// right movers wrap to 0 once x reaches windowWidth
+// left movers wrap to windowWidth - w once they are fully off screen
+void MoveLanesScalar(int *x, const int *w, const int *vel, size_t count, int windowWidth);
+#if defined(__SSE2__)
+void MoveLanesSSE2(int *x, const int *w, const int *vel, size_t count, int windowWidth);
+#endif
+#if defined(FROGGER_AVX2_KERNEL)
+bool CpuHasAVX2();
+void MoveLanesAVX2(int *x, const int *w, const int *vel, size_t count, int windowWidth);
+#endif
+
+#endif
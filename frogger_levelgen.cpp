@@ -0,0 +1,222 @@
+// Monte-Carlo level generator
+// every candidate has its own random stream from (seed, index) so the pool
+// is bit for bit the same no matter how many threads made it
+
+#include "frogger_levelgen.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+LevelGenOptions DefaultLevelGenOptions(){
+    LevelGenOptions options;
+    options.seed = 0;
+    options.candidates = 256;
+    options.poolSize = 32;
+    options.threads = 0;
+    options.moveInterval = 8;
+    options.horizon = 60 * ticksPerSecond;
+    options.maxSpeed = maxLaneSpeed;
+    return options;
+}
+
+// random layout with the same rows as addEnemies, but lanes vary in
+// how many objects they have, how wide logs are and how fast they go
+void GenerateCandidate(Level &level, const Game &shape, uint64_t seed, int index, int maxSpeed){
+    Rng candidate = SplitRng(MakeRng(seed, LevelGenStreams), index);
+    Rng rng = SplitRng(candidate, 0);
+    int width = shape.windowRect.w;
+
+    level.laneY.clear();
+    for(int a = 0; a < ArchetypeCount; a++)
+        ClearLanes(level.lanes[a]);
+
+    // logs alternate direction like addEnemies so rows don't all drift one way
+    int row = firstRowPos;
+    Direction dir = RandomBelow(rng, 2) ? Right : Left;
+    for(int l = 0; l < 7; l++){
+        int lane = level.laneY.size();
+        level.laneY.push_back(row);
+        rng = SplitRng(candidate, lane + 1);
+        Fixed speed = ToFixed(RandomBelow(rng, maxSpeed) + 1);
+        Fixed vel = dir == Right ? speed : -speed;
+        int count = RandomBelow(rng, 2) + 2;
+        int segment = width / count;
+        for(int k = 0; k < count; k++){
+            int w = 20 * (RandomBelow(rng, 3) + 1);
+            int x = k * segment + RandomBelow(rng, std::max(1, segment - w));
+            AddToLanes(level.lanes[LogArchetype], ToFixed(x), ToFixed(w), vel, lane);
+        }
+        dir = dir == Right ? Left : Right;
+        row += 25;
+    }
+    row += 50; // skip green grass in middle
+
+    for(int l = 0; l < 7; l++){
+        int lane = level.laneY.size();
+        level.laneY.push_back(row);
+        rng = SplitRng(candidate, lane + 1);
+        Fixed speed = ToFixed(RandomBelow(rng, maxSpeed) + 1);
+        Fixed vel = RandomBelow(rng, 2) ? speed : -speed;
+        int count = RandomBelow(rng, 3) + 2;
+        int segment = width / count;
+        for(int k = 0; k < count; k++){
+            int x = k * segment + RandomBelow(rng, std::max(1, segment - 20));
+            AddToLanes(level.lanes[EnemyArchetype], ToFixed(x), ToFixed(20), vel, lane);
+        }
+        row += 25;
+    }
+}
+
+// a player the solver is still tracking
+struct SolverState{
+    int x;
+    int y;
+    ObjectIndex ride;
+    Fixed carry; // sub pixel ride, see RideLog
+};
+
+// time expanded reachability from the start position
+// every tick all reachable players are stepped against the same board, a new
+// key press is allowed every moveInterval ticks, players that land on the same
+// spot are merged since the rest of their future is identical (pool lanes move
+// whole pixels, so riders never carry a sub pixel part that could tell them apart)
+SolveResult SolveLevel(const Game &start, int moveInterval, int horizon){
+    SolveResult result = {false, -1, 0.0};
+    Game board = start;
+    board.ticks = 0;
+    InvalidateGrid(board.grid);
+
+    int width = board.windowRect.w;
+    int startY = board.playerPos.y;
+    int cols = 3 * width;
+    int rows = startY / board.movementFactor + 2;
+
+    // tick each spot was last reached on, saves clearing it every tick
+    std::vector<int> seen(cols * rows, -1);
+
+    std::vector<SolverState> frontier, next;
+    SolverState first = {board.playerPos.x, board.playerPos.y, noObject, 0};
+    frontier.push_back(first);
+
+    const Action actions[] = {NoAction, MoveUp, MoveDown, MoveLeft, MoveRight};
+    long long tries = 0;
+    long long deaths = 0;
+
+    for(int t = 0; t < horizon && !frontier.empty(); t++){
+        board.ticks++;
+        MoveArchetypes(board);
+
+        int actionCount = t % moveInterval == 0 ? 5 : 1;
+        next.clear();
+        for(const auto &s : frontier){
+            for(int a = 0; a < actionCount; a++){
+                Rect pos = {s.x, s.y, board.playerPos.w, board.playerPos.h};
+                Fixed carry = 0;
+                if(s.ride.index >= 0){
+                    carry = s.carry;
+                    RideLog(pos, carry, board.lanes[s.ride.archetype].vel[s.ride.index]);
+                }
+                ApplyAction(pos, actions[a], board.movementFactor);
+
+                ObjectIndex ride = noObject;
+                tries++;
+                TickResult outcome = ResolvePlayer(board, pos, ride);
+                if(outcome == Dead){
+                    deaths++;
+                    continue;
+                }
+                if(outcome == LevelUp){
+                    result.solvable = true;
+                    result.crossingTicks = t + 1;
+                    result.deathRate = (double)deaths / tries;
+                    return result;
+                }
+
+                // y only ever sits on the movementFactor grid below startY
+                int col = pos.x + width;
+                int row = (startY - pos.y) / board.movementFactor;
+                if(col >= 0 && col < cols && row >= 0 && row < rows){
+                    int &stamp = seen[row * cols + col];
+                    if(stamp == t) continue;
+                    stamp = t;
+                }
+                SolverState state = {pos.x, pos.y, ride, ride.index >= 0 ? carry : 0};
+                next.push_back(state);
+            }
+        }
+        frontier.swap(next);
+    }
+
+    result.deathRate = tries > 0 ? (double)deaths / tries : 1.0;
+    return result;
+}
+
+// average lane speed in pixels per tick
+static double AverageSpeed(const Level &level){
+    double total = 0;
+    size_t count = 0;
+    for(int a = 0; a < ArchetypeCount; a++){
+        count += LanesSize(level.lanes[a]);
+        for(Fixed v : level.lanes[a].vel) total += FixedToDouble(v < 0 ? -v : v);
+    }
+    return count > 0 ? total / count : 0;
+}
+
+// makes options.candidates layouts in parallel, keeps the solvable ones and
+// fills pool with up to options.poolSize of them spread from easiest to hardest
+// returns how many candidates were solvable
+int GenerateLevelPool(LevelPool &pool, const Game &shape, const LevelGenOptions &options){
+    int count = options.candidates;
+    std::vector<Level> candidates(count);
+    std::vector<SolveResult> results(count);
+    std::atomic<int> nextCandidate(0);
+
+    auto worker = [&](){
+        Game start = shape;
+        start.levelPool = NULL;
+        for(int i = nextCandidate++; i < count; i = nextCandidate++){
+            Level &level = candidates[i];
+            GenerateCandidate(level, shape, options.seed, i, options.maxSpeed);
+
+            LoadLevel(start, level);
+            ResetPlayerPos(start);
+            start.ride = noObjectHandle;
+            results[i] = SolveLevel(start, options.moveInterval, options.horizon);
+
+            // difficulty mixes how fast the lanes are, how punishing the board
+            // is and how long the best crossing takes
+            level.crossingTicks = results[i].crossingTicks;
+            level.difficulty = AverageSpeed(level) + 10.0 * results[i].deathRate
+                + (double)results[i].crossingTicks / ticksPerSecond;
+        }
+    };
+
+    int threads = options.threads > 0 ? options.threads : std::thread::hardware_concurrency();
+    if(threads < 1) threads = 1;
+    std::vector<std::thread> workers;
+    for(int t = 1; t < threads; t++)
+        workers.push_back(std::thread(worker));
+    worker();
+    for(auto &w : workers)
+        w.join();
+
+    // sort by difficulty, ties by index so the order never depends on timing
+    std::vector<int> solvable;
+    for(int i = 0; i < count; i++)
+        if(results[i].solvable)
+            solvable.push_back(i);
+    std::sort(solvable.begin(), solvable.end(), [&](int a, int b){
+        if(candidates[a].difficulty != candidates[b].difficulty)
+            return candidates[a].difficulty < candidates[b].difficulty;
+        return a < b;
+    });
+
+    pool.levels.clear();
+    int keep = std::min<int>(options.poolSize, solvable.size());
+    for(int k = 0; k < keep; k++){
+        // evenly spaced picks so the pool still ramps from easy to hard
+        size_t pick = keep > 1 ? (size_t)k * (solvable.size() - 1) / (keep - 1) : 0;
+        pool.levels.push_back(candidates[solvable[pick]]);
+    }
+    return solvable.size();
+}
@@ -0,0 +1,33 @@
+// Monte-Carlo level generator
+// random layouts are made on every core, only the ones a player can actually
+// cross are kept and they are sorted by how hard they are
+
+#ifndef FROGGER_LEVELGEN_H
+#define FROGGER_LEVELGEN_H
+
+#include "frogger_sim.h"
+
+struct LevelGenOptions{
+    uint64_t seed;
+    int candidates;    // layouts to try
+    int poolSize;      // most levels to keep
+    int threads;       // 0 uses every core
+    int moveInterval;  // ticks between two key presses of the solver's player
+    int horizon;       // ticks the solver gets to cross before giving up
+    int maxSpeed;      // fastest lane in pixels per tick
+};
+
+// what the solver found out about a layout
+struct SolveResult{
+    bool solvable;
+    int crossingTicks; // fastest crossing, -1 if none
+    double deathRate;  // share of tried moves that killed the player
+};
+
+// PROTOTYPES
+LevelGenOptions DefaultLevelGenOptions();
+void GenerateCandidate(Level &level, const Game &shape, uint64_t seed, int index, int maxSpeed);
+SolveResult SolveLevel(const Game &start, int moveInterval, int horizon);
+int GenerateLevelPool(LevelPool &pool, const Game &shape, const LevelGenOptions &options);
+
+#endif
@@ -0,0 +1,65 @@
+// frame pacing on the performance counter
+
+#include "frogger_pacer.h"
+
+void InitFramePacer(FramePacer &pacer, double hz, bool vsync){
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    pacer.period = freq / hz;
+    pacer.nextFrame = SDL_GetPerformanceCounter() + pacer.period;
+    pacer.spinMargin = freq / 500; // 2ms until SDL_Delay has shown how late it wakes
+    pacer.vsync = vsync;
+}
+
+// sleeps and spins until the counter reaches deadline
+// SDL_Delay's lateness is learned so the spin stays short
+static void WaitUntil(FramePacer &pacer, Uint64 deadline){
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    if(now + pacer.spinMargin < deadline){
+        Uint64 sleep = deadline - pacer.spinMargin - now;
+        Uint32 ms = sleep * 1000 / freq;
+        if(ms > 0){
+            SDL_Delay(ms);
+
+            // learn how late SDL_Delay wakes up, between 0.5ms and 4ms of spinning
+            Uint64 woke = SDL_GetPerformanceCounter();
+            Uint64 asked = (Uint64)ms * freq / 1000;
+            Uint64 late = woke - now > asked ? woke - now - asked : 0;
+            if(late > pacer.spinMargin)
+                pacer.spinMargin = late;
+            else
+                pacer.spinMargin -= (pacer.spinMargin - late) / 16;
+            if(pacer.spinMargin < freq / 2000) pacer.spinMargin = freq / 2000;
+            if(pacer.spinMargin > freq / 250) pacer.spinMargin = freq / 250;
+        }
+    }
+
+    while(SDL_GetPerformanceCounter() < deadline){}
+}
+
+// waits until the next frame is due, call once per frame after presenting
+// a frame that ran more than a period late starts the schedule over
+// instead of rushing the following frames
+// with vsync the present already waits for the display and frames are only
+// held back when they come more than a quarter period early, as when the
+// driver ignores vsync or the window is hidden, the slack keeps the pacer
+// from pushing a frame the display paced past its refresh
+void PaceFrame(FramePacer &pacer){
+    Uint64 now = SDL_GetPerformanceCounter();
+    if(now >= pacer.nextFrame + pacer.period){
+        pacer.nextFrame = now + pacer.period;
+        return;
+    }
+
+    if(pacer.vsync){
+        Uint64 due = pacer.nextFrame;
+        if(now + pacer.period / 4 < due)
+            WaitUntil(pacer, due - pacer.period / 4);
+        // early frames stay on the schedule so they average out at the refresh rate
+        pacer.nextFrame = (now > due ? now : due) + pacer.period;
+        return;
+    }
+
+    WaitUntil(pacer, pacer.nextFrame);
+    pacer.nextFrame += pacer.period;
+}
@@ -0,0 +1,23 @@
+// frame pacing on the performance counter
+// sleeps most of the wait with SDL_Delay, which only has millisecond
+// granularity and may oversleep, then spins the last bit to hit the deadline
+// with a vsync renderer the present already waits for the display and the
+// pacer only caps frames at the refresh rate in case it doesn't
+
+#ifndef FROGGER_PACER_H
+#define FROGGER_PACER_H
+
+#include <SDL2/SDL.h>
+
+struct FramePacer{
+    Uint64 period;     // counter units per frame
+    Uint64 nextFrame;  // counter value the next frame is due at
+    Uint64 spinMargin; // end of the wait that is spun instead of slept
+    bool vsync;        // SDL_RenderPresent should pace the frames, the pacer only caps them
+};
+
+// PROTOTYPES
+void InitFramePacer(FramePacer &pacer, double hz, bool vsync);
+void PaceFrame(FramePacer &pacer);
+
+#endif
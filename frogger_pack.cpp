@@ -0,0 +1,39 @@
+// offline asset packer
+// decodes every sprite in img/, lays them out like the runtime atlas and
+// writes the sheet in the renderer's pixel format to img/sprites.pack
+//
+// usage: frogger_pack [output]
+
+#include <SDL2/SDL.h>
+#include <iostream>
+#include "frogger_atlas.h"
+#include "frogger_assetpack.h"
+
+int main(int argc, char*args[]){
+    std::string path = argc > 1 ? args[1] : assetPackPath;
+
+    if(!InitSpriteDecoding()) return 1;
+    SpriteLoader loader;
+    StartSpriteLoader(loader);
+    for(int i = 0; i < SpriteCount; i++){
+        if(WaitForSprite(loader, (SpriteId)i) == NULL){
+            StopSpriteLoader(loader);
+            return 1;
+        }
+    }
+
+    Atlas atlas;
+    SDL_Surface *sheet = ComposeAtlas(atlas, loader.surfaces, assetPackFormat);
+    StopSpriteLoader(loader);
+    if(sheet == NULL) return 1;
+
+    bool written = WriteAssetPack(path, atlas, sheet);
+    SDL_FreeSurface(sheet);
+    if(!written){
+        std::cout << "Failed to write " << path << std::endl;
+        return 1;
+    }
+    std::cout << "packed " << SpriteCount << " sprites into " << path << " ("
+              << atlas.width << "x" << atlas.height << ")" << std::endl;
+    return 0;
+}
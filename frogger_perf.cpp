@@ -0,0 +1,36 @@
+// frame timings per phase of the game loop
+
+#include "frogger_perf.h"
+#include <algorithm>
+
+thread_local PerfStats perfStats;
+
+// moves the frame being timed into the history and starts a new one
+void EndPerfFrame(){
+    for(int p = 0; p < PerfPhaseCount; p++){
+        perfStats.history[p][perfStats.next] = perfStats.current[p];
+        perfStats.current[p] = 0;
+    }
+    perfStats.next = (perfStats.next + 1) % perfHistory;
+    if(perfStats.count < perfHistory)
+        perfStats.count++;
+}
+
+// median and 99th percentile of a phase over the kept frames
+void PerfPercentiles(PerfPhase phase, float &p50, float &p99){
+    p50 = p99 = 0;
+    int count = perfStats.count;
+    if(count == 0) return;
+
+    float sorted[perfHistory];
+    std::copy(perfStats.history[phase], perfStats.history[phase] + count, sorted);
+    std::sort(sorted, sorted + count);
+    p50 = sorted[(count - 1) / 2];
+    p99 = sorted[(count - 1) * 99 / 100];
+}
+
+// time of a phase age frames ago, 0 is the last finished frame
+float PerfSample(PerfPhase phase, int age){
+    if(age >= perfStats.count) return 0;
+    return perfStats.history[phase][(perfStats.next - 1 - age + perfHistory) % perfHistory];
+}
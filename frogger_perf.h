@@ -0,0 +1,68 @@
+// frame timings per phase of the game loop
+// PERF_SCOPE(phase) adds the time until the end of the enclosing block to the
+// phase, EndPerfFrame closes a frame and keeps the last perfHistory of them
+// build without FROGGER_PERF and the timers compile to nothing
+
+#ifndef FROGGER_PERF_H
+#define FROGGER_PERF_H
+
+#include <chrono>
+
+// frames kept for the graphs and percentiles
+const int perfHistory = 120;
+
+// parts of a frame of RunGame
+enum PerfPhase{
+    PerfEvents,     // polling input
+    PerfMovement,   // moving the lanes
+    PerfCollision,  // resolving the player
+    PerfRender,     // building the frame
+    PerfPresent,    // SDL_RenderPresent
+    PerfDelay,      // waiting for the next frame
+    PerfPhaseCount
+};
+
+// microseconds spent in every phase, per frame
+struct PerfStats{
+    bool enabled;                               // timers do nothing until set
+    float current[PerfPhaseCount];              // frame being timed
+    float history[PerfPhaseCount][perfHistory]; // ring of finished frames
+    int next;                                   // slot the next frame goes in
+    int count;                                  // frames in history so far
+};
+
+// per thread so simulations on other threads never touch the game's numbers
+extern thread_local PerfStats perfStats;
+
+// adds the lifetime of the timer to a phase
+// only reads the clock when the thread turned timing on, so headless runs
+// of the same code don't pay for it
+struct ScopedTimer{
+    PerfPhase phase;
+    bool timing;
+    std::chrono::steady_clock::time_point start;
+
+    ScopedTimer(PerfPhase p) : phase(p), timing(perfStats.enabled){
+        if(timing) start = std::chrono::steady_clock::now();
+    }
+    ~ScopedTimer(){
+        if(!timing) return;
+        std::chrono::duration<float, std::micro> spent = std::chrono::steady_clock::now() - start;
+        perfStats.current[phase] += spent.count();
+    }
+};
+
+#ifdef FROGGER_PERF
+#define PERF_CONCAT2(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT2(a, b)
+#define PERF_SCOPE(phase) ScopedTimer PERF_CONCAT(perfTimer, __LINE__)(phase)
+#else
+#define PERF_SCOPE(phase)
+#endif
+
+// PROTOTYPES
+void EndPerfFrame();
+void PerfPercentiles(PerfPhase phase, float &p50, float &p99);
+float PerfSample(PerfPhase phase, int age);
+
+#endif
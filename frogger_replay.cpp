@@ -0,0 +1,198 @@
+// replay recording and playback
+
+#include "frogger_replay.h"
+
+// flush to the writer thread once this much is buffered
+const size_t replayFlushBytes = 4096;
+
+static void PutVarint(std::vector<uint8_t> &out, uint64_t value){
+    while(value >= 0x80){
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+// false if the data ends in the middle of a number
+static bool GetVarint(const std::vector<uint8_t> &in, size_t &pos, uint64_t &value){
+    value = 0;
+    for(int shift = 0; shift < 64 && pos < in.size(); shift += 7){
+        uint8_t byte = in[pos++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if(!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// writes whatever the game hands over until the writer is closed
+static void WriterLoop(ReplayWriter *writer){
+    std::vector<uint8_t> chunk;
+    for(;;){
+        {
+            std::unique_lock<std::mutex> guard(writer->lock);
+            writer->wake.wait(guard, [&]{ return writer->closing || !writer->flushing.empty(); });
+            if(writer->flushing.empty() && writer->closing) return;
+            chunk.swap(writer->flushing);
+        }
+        fwrite(chunk.data(), 1, chunk.size(), writer->file);
+        fflush(writer->file);
+        chunk.clear();
+    }
+}
+
+// creates the file, writes the header and starts the writer thread
+bool OpenReplayWriter(ReplayWriter &writer, const std::string &path, const ReplayHeader &header){
+    writer.file = fopen(path.c_str(), "wb");
+    if(writer.file == NULL) return false;
+
+    std::vector<uint8_t> start;
+    start.push_back('F');
+    start.push_back('R');
+    start.push_back('P');
+    start.push_back('L');
+    PutVarint(start, replayVersion);
+    PutVarint(start, header.seed);
+    PutVarint(start, header.width);
+    PutVarint(start, header.height);
+    PutVarint(start, header.levels);
+    fwrite(start.data(), 1, start.size(), writer.file);
+
+    writer.lastTick = 0;
+    writer.closing = false;
+    writer.active.reserve(2 * replayFlushBytes);
+    writer.flushing.reserve(2 * replayFlushBytes);
+    writer.writer = std::thread(WriterLoop, &writer);
+    return true;
+}
+
+// appends one record, only takes the lock to hand a full buffer over
+// if the writer is still busy the buffer just keeps growing
+void RecordEvent(ReplayWriter &writer, unsigned long tick, ReplayEventType type, int value){
+    if(writer.file == NULL) return;
+    PutVarint(writer.active, (uint64_t)(tick - writer.lastTick) << 4 | type);
+    if(type == ReplayLevelUp)
+        PutVarint(writer.active, value);
+    writer.lastTick = tick;
+
+    if(writer.active.size() >= replayFlushBytes){
+        std::unique_lock<std::mutex> guard(writer.lock, std::try_to_lock);
+        if(guard.owns_lock() && writer.flushing.empty()){
+            writer.active.swap(writer.flushing);
+            writer.wake.notify_one();
+        }
+    }
+}
+
+// writes out what is left and closes the file
+void CloseReplayWriter(ReplayWriter &writer){
+    if(writer.file == NULL) return;
+    {
+        std::lock_guard<std::mutex> guard(writer.lock);
+        writer.flushing.insert(writer.flushing.end(), writer.active.begin(), writer.active.end());
+        writer.active.clear();
+        writer.closing = true;
+    }
+    writer.wake.notify_one();
+    writer.writer.join();
+    fclose(writer.file);
+    writer.file = NULL;
+}
+
+// decodes the record at reader.pos into reader.next
+static void ReadNext(ReplayReader &reader){
+    uint64_t record;
+    reader.hasNext = false;
+    if(reader.pos >= reader.data.size() || !GetVarint(reader.data, reader.pos, record))
+        return;
+
+    reader.next.tick = reader.lastTick + (record >> 4);
+    reader.next.type = (ReplayEventType)(record & 0xf);
+    reader.next.value = 0;
+    if(reader.next.type == ReplayLevelUp){
+        uint64_t value;
+        if(!GetVarint(reader.data, reader.pos, value)) return;
+        reader.next.value = value;
+    }
+    reader.lastTick = reader.next.tick;
+    reader.hasNext = true;
+}
+
+// loads a replay file and reads its header, false if it isn't one
+bool OpenReplayReader(ReplayReader &reader, const std::string &path){
+    FILE *file = fopen(path.c_str(), "rb");
+    if(file == NULL) return false;
+    reader.data.clear();
+    uint8_t buffer[65536];
+    size_t got;
+    while((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        reader.data.insert(reader.data.end(), buffer, buffer + got);
+    fclose(file);
+
+    if(reader.data.size() < 4 || reader.data[0] != 'F' || reader.data[1] != 'R'
+       || reader.data[2] != 'P' || reader.data[3] != 'L')
+        return false;
+    reader.pos = 4;
+
+    uint64_t version, seed, width, height, levels;
+    if(!GetVarint(reader.data, reader.pos, version) || version != replayVersion) return false;
+    if(!GetVarint(reader.data, reader.pos, seed)) return false;
+    if(!GetVarint(reader.data, reader.pos, width)) return false;
+    if(!GetVarint(reader.data, reader.pos, height)) return false;
+    if(!GetVarint(reader.data, reader.pos, levels)) return false;
+    reader.header.seed = seed;
+    reader.header.width = width;
+    reader.header.height = height;
+    reader.header.levels = levels;
+
+    reader.lastTick = 0;
+    ReadNext(reader);
+    return true;
+}
+
+// looks at the next event without using it up, false at the end
+bool PeekReplayEvent(const ReplayReader &reader, ReplayEvent &event){
+    if(!reader.hasNext) return false;
+    event = reader.next;
+    return true;
+}
+
+bool NextReplayEvent(ReplayReader &reader, ReplayEvent &event){
+    if(!reader.hasNext) return false;
+    event = reader.next;
+    ReadNext(reader);
+    return true;
+}
+
+// applies every key press recorded for the given tick
+void ApplyReplayMoves(ReplayReader &reader, Game &game, unsigned long tick){
+    ReplayEvent event;
+    while(PeekReplayEvent(reader, event) && event.tick == tick && event.type <= ReplayMoveRight){
+        MovePlayer(game, (Action)(event.type + 1));
+        NextReplayEvent(reader, event);
+    }
+}
+
+// record type of a key press
+ReplayEventType MoveEventOf(Action action){
+    return (ReplayEventType)(action - 1);
+}
+
+// uses up the level up or death recorded for the given tick
+// false if it doesn't match what the simulation just did
+bool CheckReplayOutcome(ReplayReader &reader, unsigned long tick, TickResult result){
+    ReplayEvent event;
+    TickResult recorded = Alive;
+    while(PeekReplayEvent(reader, event) && event.tick == tick
+          && (event.type == ReplayLevelUp || event.type == ReplayDeath)){
+        recorded = event.type == ReplayDeath ? Dead : LevelUp;
+        NextReplayEvent(reader, event);
+    }
+    return recorded == result;
+}
+
+// next pause, resume, restart or quit recorded before the given tick runs
+bool NextControlEvent(ReplayReader &reader, unsigned long tick, ReplayEvent &event){
+    if(!PeekReplayEvent(reader, event) || event.tick != tick) return false;
+    if(event.type < ReplayPause || event.type > ReplayQuit) return false;
+    return NextReplayEvent(reader, event);
+}
@@ -0,0 +1,90 @@
+// input replays
+// a replay is the seed plus every tick stamped key press, pause, restart and
+// level change of a run, so the simulation can be driven again exactly
+//
+// file layout, all numbers are LEB128 varints
+//   "FRPL" version seed width height levels
+//   then one record per event: (ticks since last event << 4 | type) [value]
+// only ReplayLevelUp carries a value (the level reached)
+
+#ifndef FROGGER_REPLAY_H
+#define FROGGER_REPLAY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "frogger_sim.h"
+
+const int replayVersion = 4; // 2: lanes speed up in fixed point, 3: up to maxLaneSpeed, 4: one random number per lane
+
+// the 4 moves share their numbers with Action - 1 so a key press is one record
+enum ReplayEventType{
+    ReplayMoveUp = 0,
+    ReplayMoveDown = 1,
+    ReplayMoveLeft = 2,
+    ReplayMoveRight = 3,
+    ReplayPause = 4,
+    ReplayResume = 5,
+    ReplayRestart = 6,
+    ReplayQuit = 7,
+    ReplayLevelUp = 8,
+    ReplayDeath = 9
+};
+
+// moves and outcomes are stamped with the tick they happened in,
+// everything else with the number of ticks run before it
+struct ReplayEvent{
+    unsigned long tick;
+    ReplayEventType type;
+    int value;
+};
+
+// what is needed to rebuild the game the replay was recorded on
+struct ReplayHeader{
+    uint64_t seed;
+    int width;
+    int height;
+    int levels; // --levels pool size, 0 for random lanes
+};
+
+// appends records to a memory buffer, a background thread writes full
+// buffers out so recording never waits on the disk
+struct ReplayWriter{
+    FILE *file;
+    unsigned long lastTick;
+    std::vector<uint8_t> active;   // filled by the game
+    std::vector<uint8_t> flushing; // handed to the writer thread
+    std::mutex lock;
+    std::condition_variable wake;
+    bool closing;
+    std::thread writer;
+};
+
+// whole replay file in memory, read front to back
+struct ReplayReader{
+    ReplayHeader header;
+    std::vector<uint8_t> data;
+    size_t pos;
+    unsigned long lastTick;
+    bool hasNext;
+    ReplayEvent next;
+};
+
+// PROTOTYPES
+bool OpenReplayWriter(ReplayWriter &writer, const std::string &path, const ReplayHeader &header);
+void RecordEvent(ReplayWriter &writer, unsigned long tick, ReplayEventType type, int value = 0);
+void CloseReplayWriter(ReplayWriter &writer);
+
+bool OpenReplayReader(ReplayReader &reader, const std::string &path);
+bool PeekReplayEvent(const ReplayReader &reader, ReplayEvent &event);
+bool NextReplayEvent(ReplayReader &reader, ReplayEvent &event);
+void ApplyReplayMoves(ReplayReader &reader, Game &game, unsigned long tick);
+bool CheckReplayOutcome(ReplayReader &reader, unsigned long tick, TickResult result);
+bool NextControlEvent(ReplayReader &reader, unsigned long tick, ReplayEvent &event);
+ReplayEventType MoveEventOf(Action action);
+
+#endif
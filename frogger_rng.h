@@ -0,0 +1,69 @@
+// counter based random numbers
+// the n-th number of a stream only depends on the stream key and n, so streams
+// can be split per session and level, skipped through per lane, and handed to
+// any thread without sharing state, and the same seed always gives the same layouts
+
+#ifndef FROGGER_RNG_H
+#define FROGGER_RNG_H
+
+#include <stdint.h>
+
+// top level streams of a seed, one per user so they never overlap
+enum RngDomain{
+    SessionStreams = 1,   // lane layouts of every game session
+    LevelGenStreams = 2,  // level generator candidates
+    PolicyStreams = 3,    // inputs of the headless runner
+    EnvStreams = 4        // episode seeds of the batched env, one stream per game
+};
+
+struct Rng{
+    uint64_t key;      // picks the stream
+    uint64_t counter;  // how many numbers were drawn
+};
+
+// splitmix64 finalizer, turns a counter into a well mixed number
+inline uint64_t MixBits(uint64_t z){
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// stream number stream of the given seed
+inline Rng MakeRng(uint64_t seed, uint64_t stream){
+    Rng rng;
+    rng.key = MixBits(seed ^ MixBits(stream + 0x9E3779B97F4A7C15ull));
+    rng.counter = 0;
+    return rng;
+}
+
+// independent child stream, the parent is left untouched
+inline Rng SplitRng(const Rng &parent, uint64_t stream){
+    return MakeRng(parent.key, stream);
+}
+
+inline uint64_t NextRandom(Rng &rng){
+    rng.counter++;
+    return MixBits(rng.key + rng.counter * 0x9E3779B97F4A7C15ull);
+}
+
+// skips n numbers in constant time
+inline void SkipRandom(Rng &rng, uint64_t n){
+    rng.counter += n;
+}
+
+// number in [0, n) from the top of a 32 bit fraction, multiply and shift
+// instead of modulo, fraction keeps the bits that weren't used so one random
+// number gives several draws while the product of their n stays far below 2^32
+inline int TakeBelow(uint32_t &fraction, int n){
+    uint64_t product = (uint64_t)fraction * (uint64_t)n;
+    fraction = (uint32_t)product;
+    return (int)(product >> 32);
+}
+
+// number in [0, n) from the next random number
+inline int RandomBelow(Rng &rng, int n){
+    uint32_t fraction = NextRandom(rng) >> 32;
+    return TakeBelow(fraction, n);
+}
+
+#endif
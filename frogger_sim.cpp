@@ -0,0 +1,400 @@
+// game rules of frogger without any SDL dependency
+// everything here works on a Game so it can be stepped as fast as the CPU allows
+
+#include "frogger_sim.h"
+#include <stdlib.h>
+
+// sets up the bars, player and lanes for a window of the given size
+// lanes come from pool when there is one, otherwise they are random
+void InitGame(Game &game, int width, int height, uint64_t seed, const LevelPool *pool){
+    game.windowRect.x = 0;
+    game.windowRect.y = 0;
+    game.windowRect.w = width;
+    game.windowRect.h = height;
+
+    game.movementFactor = 25;
+
+    // Init top and bottom bar
+    game.topBar.x = 0;
+    game.topBar.y = 0;
+    game.topBar.w = width;
+    game.topBar.h = 20;
+
+    game.bottomBar.x = 0;
+    game.bottomBar.y = height - 20;
+    game.bottomBar.w = width;
+    game.bottomBar.h = 20;
+
+    // Initialize our player
+    game.playerPos.w = 20;
+    game.playerPos.h = 15;
+
+    for(int a = 0; a < ArchetypeCount; a++)
+        ReserveLanes(game.lanes[a], maxLaneObjects);
+    game.laneY.reserve(maxLaneObjects);
+
+    game.levelPool = pool;
+    game.seed = seed;
+    game.session = 0;
+    ResetGame(game);
+}
+
+// starts over from the first level with fresh lanes
+void ResetGame(Game &game){
+    game.session++;
+    game.level = 0;
+    if(game.levelPool)
+        LoadLevel(game, PoolLevel(*game.levelPool, game.level));
+    else{
+        // random layouts always have the same objects per row, so the new
+        // game is written over the old one like a level up, with fresh speeds
+        addEnemies(game);
+        RebuildGrid(game.grid, game);
+    }
+
+    game.ride = noObjectHandle;
+    game.ticks = 0;
+    game.levelStartTick = 0;
+    ResetPlayerPos(game);
+}
+
+// handle if player is on log (move with log)
+// a ride that is gone since the last tick doesn't carry the player
+void BeginTick(Game &game){
+    ObjectIndex ride = RideIndex(game);
+    if (ride.index >= 0)
+        RideLog(game.playerPos, game.rideCarry, game.lanes[ride.archetype].vel[ride.index]);
+    else
+        game.rideCarry = 0;
+}
+
+// moves pos along with a log of the given speed for one tick
+// the player stays on whole pixels, carry keeps the sub pixel part for later ticks
+void RideLog(Rect &pos, Fixed &carry, Fixed vel){
+    Fixed moved = carry + vel;
+    pos.x += FixedToInt(moved);
+    carry = FixedFraction(moved);
+}
+
+// moves the player one step in the direction of the action
+void MovePlayer(Game &game, Action action){
+    ApplyAction(game.playerPos, action, game.movementFactor);
+}
+
+// moves pos one step of the given size in the direction of the action
+void ApplyAction(Rect &pos, Action action, int movementFactor){
+    switch(action){
+        case MoveRight:
+            pos.x += movementFactor;
+            break;
+        case MoveLeft:
+            pos.x -= movementFactor;
+            break;
+        case MoveDown:
+            pos.y += movementFactor;
+            break;
+        case MoveUp:
+            pos.y -= movementFactor;
+            break;
+        default:
+            break;
+    }
+}
+
+// moves the lanes and resolves what happened to the player
+TickResult EndTick(Game &game){
+    AdvanceLanes(game);
+    return SettlePlayer(game);
+}
+
+// first half of EndTick, moves every object one tick
+void AdvanceLanes(Game &game){
+    game.ticks++;
+    MoveArchetypes(game);
+}
+
+// second half of EndTick, resolves the player against the moved lanes
+// and starts the next level when they got across
+TickResult SettlePlayer(Game &game){
+    ObjectIndex ride = RideIndex(game);
+    TickResult result = ResolvePlayer(game, game.playerPos, ride);
+    SetRide(game, ride);
+    if(result == LevelUp)
+        NextLevel(game);
+    return result;
+}
+
+// applies the rules to a player at pos against the lanes as they are now
+// pos is kept on screen and ride becomes the object under the player
+// used by EndTick and by the level generator to try many players on one board
+TickResult ResolvePlayer(Game &game, Rect &pos, ObjectIndex &ride){
+    // one query for both enemies and the log player is on
+    return ApplyHits(game, pos, QueryGrid(game.grid, game, pos), ride);
+}
+
+// the rules once it is known what the player at pos touches
+// the batched env finds hits its own way and shares the rest through here
+TickResult ApplyHits(const Game &game, Rect &pos, const PlayerHits &hits, ObjectIndex &ride){
+    // Check collisions against enemies
+    if(hits.hitEnemy)
+        return Dead;
+
+    // Check collisions against logs
+    ride = hits.ride; // getting log player is on
+
+    // handle if player is in water and not on log
+    if (ride.index < 0 && pos.y < waterBottom && pos.y > waterTop)
+        return Dead;
+
+    // check if player is off screen
+    if(pos.y > game.windowRect.h)
+        pos.y = game.windowRect.h - 20;
+    else if(pos.x < 0)
+        pos.x = 0;
+    else if(pos.x > game.windowRect.w)
+        pos.x = game.windowRect.w - pos.w;
+
+    // check collision against top bar (win the level)
+    // since top bar covers the entire width, we only need to check y value
+    // topBar.y refers to the top of the top bar, so topBar.y + topBar.h
+    if(pos.y < (game.topBar.y + game.topBar.h))
+        return LevelUp;
+    return Alive;
+}
+
+// runs a whole tick with a single player action
+TickResult StepGame(Game &game, Action action){
+    BeginTick(game);
+    MovePlayer(game, action);
+    return EndTick(game);
+}
+
+// moves every lane straight to where it is on the given tick of the current level
+// without stepping the ticks in between, the player stays where it is
+// ticks before the level started can't be reached and go to the level start
+void SeekGame(Game &game, unsigned long tick){
+    if(tick < game.levelStartTick)
+        tick = game.levelStartTick;
+    unsigned long t = tick - game.levelStartTick;
+
+    for(int a = 0; a < ArchetypeCount; a++)
+        SeekLanes(game.lanes[a], t, game.windowRect.w);
+    game.ticks = tick;
+
+    // the player may be on a different log now, and whatever the old one
+    // carried them is from ticks that were skipped
+    InvalidateGrid(game.grid);
+    SetRide(game, QueryGrid(game.grid, game, game.playerPos).ride);
+    game.rideCarry = 0;
+}
+
+// puts the player back at the bottom and respawns faster lanes
+// with a level pool the next level is just the next harder pool entry
+void NextLevel(Game &game){
+    ResetPlayerPos(game);
+    game.level++;
+    game.levelStartTick = game.ticks;
+
+    // the log the player was on is gone
+    game.ride = noObjectHandle;
+
+    if(game.levelPool){
+        LoadLevel(game, PoolLevel(*game.levelPool, game.level));
+        return;
+    }
+
+    // respawn over the old objects, the rows speed up as they are rewritten
+    addEnemies(game);
+    RebuildGrid(game.grid, game);
+}
+
+// level to play at the given level number, harder pool entries come later
+// and the hardest one repeats once the pool runs out
+const Level & PoolLevel(const LevelPool &pool, int level){
+    size_t index = level < (int)pool.levels.size() ? level : pool.levels.size() - 1;
+    return pool.levels[index];
+}
+
+// replaces the lanes with the ones of a pregenerated level
+// copied into the game's own lanes so their memory and handles stay the game's
+void LoadLevel(Game &game, const Level &level){
+    game.laneY = level.laneY;
+    for(int a = 0; a < ArchetypeCount; a++)
+        CopyLanes(game.lanes[a], level.lanes[a]);
+    RebuildGrid(game.grid, game);
+}
+
+// moves every object on the screen according to their direction and speed
+void MoveArchetypes(Game &game){
+    for(int a = 0; a < ArchetypeCount; a++)
+        MoveLanes(game.lanes[a], game.windowRect.w);
+}
+
+// starts a new row at lastEnemyPos and returns its index
+int AddRow(Game &game){
+    game.laneY.push_back(game.lastEnemyPos);
+    return game.laneY.size() - 1;
+}
+
+// random streams of the lanes of the current level, a lane looks the same
+// whenever the same seed, session and level come around again
+Rng LevelRng(const Game &game){
+    Rng session = SplitRng(MakeRng(game.seed, SessionStreams), game.session);
+    return SplitRng(session, game.level);
+}
+
+// random stream for spawning one lane of the level levelRng came from
+// a lane only takes one number, the lane-th of the level's stream, which
+// is cheaper to skip to than a stream split off for every lane
+Rng LaneRng(const Rng &levelRng, int lane){
+    Rng rng = levelRng;
+    SkipRandom(rng, lane);
+    return rng;
+}
+
+// rectangle of object i in lanes, in whole pixels
+Rect EntityRect(const Game &game, const Lanes &lanes, size_t i){
+    Rect rect = {FixedToInt(lanes.x[i]), game.laneY[lanes.lane[i]], FixedToInt(lanes.w[i]), entityHeight};
+    return rect;
+}
+
+// checks for a general collision given two objects (all objects are rectangles)
+// true if collision, false otherwise
+bool CheckCollision(const Rect &rect1, const Rect &rect2){
+    // find edges of rect1 and rect2
+    int left1 = rect1.x;
+    int right1 = rect1.x + rect1.w;
+    int top1 = rect1.y;
+    int bottom1 = rect1.y + rect1.h;
+
+    int left2 = rect2.x;
+    int right2 = rect2.x + rect2.w;
+    int top2 = rect2.y;
+    int bottom2 = rect2.y + rect2.h;
+
+    // check edges
+    if(left1 > right2) return false; // left 1 is right of right 2
+    if(right1 < left2) return false;
+    if(top1 > bottom2) return false;
+    if(bottom1 < top2) return false;
+
+    return true;
+}
+
+// specifically checks if log objects collide with player
+// true if they do, false otherwise
+bool CheckLogCollisions(const Game &game){
+    return getLog(game) >= 0;
+}
+
+// returns the index of the log that player collides with, -1 if none
+// linear scans like this are the reference for the grid query in EndTick
+int getLog(const Game &game){
+    return FirstHit(game, game.lanes[LogArchetype], game.playerPos);
+}
+
+// specifically checks if trucks collide with player
+// true if they collide, false otherwise
+bool CheckEnemyCollisions(const Game &game){
+    return FirstHit(game, game.lanes[EnemyArchetype], game.playerPos) >= 0;
+}
+
+// object the player rides as an index, -1 if the ride is gone or there is none
+ObjectIndex RideIndex(const Game &game){
+    ObjectIndex ride = {game.ride.archetype, LaneIndex(game.lanes[game.ride.archetype], game.ride.handle)};
+    return ride;
+}
+
+// makes the object at ride the one the player rides
+void SetRide(Game &game, const ObjectIndex &ride){
+    game.ride.archetype = ride.archetype;
+    game.ride.handle = LaneHandleOf(game.lanes[ride.archetype], ride.index);
+}
+
+// index of the first object in lanes touching rect, -1 if none
+int FirstHit(const Game &game, const Lanes &lanes, const Rect &rect){
+    for(size_t i = 0; i < LanesSize(lanes); i++){
+        if(CheckCollision(EntityRect(game, lanes, i), rect))
+            return i;
+    }
+    return -1;
+}
+
+// speed of a row on the next level, up to maxLaneSpeed
+// fixed point keeps the fraction, so even the slowest rows get faster
+static Fixed LevelSpeed(Fixed vel){
+    Fixed speed = FixedMul(abs(vel), levelSpeedUp);
+    return speed < ToFixed(maxLaneSpeed) ? speed : ToFixed(maxLaneSpeed);
+}
+
+// Adds 3 enemies to a specific row
+// row is determined by value of lastEnemyPos
+// past the first level a row written over an old one keeps the old speed sped up, in its new direction
+void AddEnemy(Game &game, const Rng &levelRng){
+    int row = AddRow(game);
+    Rng rng = LaneRng(levelRng, row);
+    uint32_t fraction = NextRandom(rng) >> 32; // every draw of the row
+    Lanes &enemies = game.lanes[EnemyArchetype];
+    size_t &next = game.nextObject[EnemyArchetype];
+    Fixed speed = ToFixed(TakeBelow(fraction, 3) + 1);
+    if(game.level > 0 && next < LanesSize(enemies))
+        speed = LevelSpeed(enemies.vel[next]);
+    // used to make random between left and right direction
+    Fixed vel = TakeBelow(fraction, 2) == 0 ? speed : -speed;
+    PutInLanes(enemies, next++, ToFixed(TakeBelow(fraction, 100)), ToFixed(20), vel, row);
+    PutInLanes(enemies, next++, ToFixed(TakeBelow(fraction, 100) + 75), ToFixed(20), vel, row);
+    PutInLanes(enemies, next++, ToFixed(TakeBelow(fraction, 100) + 175), ToFixed(20), vel, row);
+    game.lastEnemyPos += 25; // so next set of enemies is on the next row
+}
+
+// Adds 1 long log and 1 short log to specific row
+// row is determined by value of lastEnemyPos
+// takes direction to make sure they move in opposite directions when called in other functions
+// old rows speed up like in AddEnemy
+void AddLog(Game &game, Direction dir, const Rng &levelRng){
+    int row = AddRow(game);
+    Rng rng = LaneRng(levelRng, row);
+    uint32_t fraction = NextRandom(rng) >> 32; // every draw of the row
+    Lanes &logs = game.lanes[LogArchetype];
+    size_t &next = game.nextObject[LogArchetype];
+    Fixed speed = ToFixed(TakeBelow(fraction, 3) + 1); // rand speed for entire row
+    if(game.level > 0 && next < LanesSize(logs))
+        speed = LevelSpeed(logs.vel[next]);
+    Fixed vel = dir == Right ? speed : -speed;
+    PutInLanes(logs, next++, ToFixed(TakeBelow(fraction, 100)), ToFixed(40), vel, row);
+    PutInLanes(logs, next++, ToFixed(TakeBelow(fraction, 100) + 175), ToFixed(20), vel, row);
+    game.lastEnemyPos += 25; // so the next set of logs is on the next row
+}
+
+// fills the screen with objects, writing over the ones already there
+void addEnemies(Game &game){
+    game.laneY.clear();
+    game.lastEnemyPos = firstRowPos;
+    for(int a = 0; a < ArchetypeCount; a++)
+        game.nextObject[a] = 0;
+    Rng levelRng = LevelRng(game);
+
+    // alternate left and right direction so player can always cross
+    AddLog(game, Right, levelRng);
+    AddLog(game, Left, levelRng);
+    AddLog(game, Right, levelRng);
+    AddLog(game, Left, levelRng);
+    AddLog(game, Right, levelRng);
+    AddLog(game, Left, levelRng);
+    AddLog(game, Right, levelRng);
+    game.lastEnemyPos += 50; // skip green grass in middle
+    AddEnemy(game, levelRng);
+    AddEnemy(game, levelRng);
+    AddEnemy(game, levelRng);
+    AddEnemy(game, levelRng);
+    AddEnemy(game, levelRng);
+    AddEnemy(game, levelRng);
+    AddEnemy(game, levelRng);
+}
+
+// puts the player on bottom of map
+void ResetPlayerPos(Game &game){
+    game.playerPos.x = (game.windowRect.w /2) - (game.playerPos.w /2);
+    game.playerPos.y = game.windowRect.h - game.bottomBar.h;
+    game.rideCarry = 0;
+}
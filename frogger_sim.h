@@ -0,0 +1,139 @@
+// game rules of frogger without any SDL dependency
+// used by frogger_SDL for both the window and the headless runner
+
+#ifndef FROGGER_SIM_H
+#define FROGGER_SIM_H
+
+#include <vector>
+#include "frogger_lanes.h"
+#include "frogger_archetypes.h"
+#include "frogger_grid.h"
+#include "frogger_rng.h"
+
+// the rules are tuned for this many ticks per second
+const int ticksPerSecond = 60;
+
+// most ticks a single frame may run to catch up after a stall
+const int maxCatchUpTicks = 8;
+
+// the water sits between the grass strips, player needs a log in here
+const int waterTop = 45;
+const int waterBottom = 224;
+
+// first row objects are placed on
+const int firstRowPos = 50;
+
+// rows speed up by this much every level, 1.2 in fixed point
+const Fixed levelSpeedUp = fixedOne * 6 / 5;
+
+// rows stop speeding up at this many pixels per tick, the fastest a generated level goes
+const int maxLaneSpeed = 4;
+
+// most enemies and most logs a game holds, the lanes are allocated once at this size
+const size_t maxLaneObjects = 64;
+
+// help with directions of objects
+enum Direction{
+    Left,
+    Right
+};
+
+// same layout as SDL_Rect so the renderer can draw it as is
+struct Rect{
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+// moves the player can make during a tick
+enum Action{
+    NoAction,
+    MoveUp,
+    MoveDown,
+    MoveLeft,
+    MoveRight
+};
+
+// what happened to the player at the end of a tick
+enum TickResult{
+    Alive,
+    Dead,
+    LevelUp
+};
+
+// a pregenerated set of lanes, see frogger_levelgen
+struct Level{
+    std::vector<int> laneY;
+    Lanes lanes[ArchetypeCount];
+    int crossingTicks;   // fastest way across found by the solver
+    double difficulty;   // higher is harder
+};
+
+// validated levels sorted from easiest to hardest
+struct LevelPool{
+    std::vector<Level> levels;
+};
+
+// everything needed to step one game
+struct Game{
+    Rect windowRect;
+    Rect playerPos;
+    Rect topBar;
+    Rect bottomBar;
+
+    std::vector<int> laneY;           // y position of every row
+    Lanes lanes[ArchetypeCount];      // every object, indexed by ArchetypeId
+    Grid grid;                        // broadphase over all lanes
+
+    int movementFactor;
+    int lastEnemyPos;
+    size_t nextObject[ArchetypeCount]; // where the spawners write, objects from here on are from the last level
+
+    ObjectHandle ride;  // object the player rides, noObjectHandle if none
+    Fixed rideCarry;    // part of a pixel the ride has carried the player but not moved them yet
+
+    const LevelPool *levelPool; // NULL spawns random lanes
+    uint64_t seed;              // random lanes depend only on seed, session, level and lane
+    uint64_t session;           // counts ResetGame calls
+    int level;
+    unsigned long ticks;
+    unsigned long levelStartTick; // tick the current lanes were spawned on
+};
+
+// PROTOTYPES
+void InitGame(Game &game, int width, int height, uint64_t seed, const LevelPool *pool = NULL);
+void ResetGame(Game &game);
+void BeginTick(Game &game);
+void MovePlayer(Game &game, Action action);
+void ApplyAction(Rect &pos, Action action, int movementFactor);
+void RideLog(Rect &pos, Fixed &carry, Fixed vel);
+TickResult EndTick(Game &game);
+void AdvanceLanes(Game &game);
+TickResult SettlePlayer(Game &game);
+TickResult ResolvePlayer(Game &game, Rect &pos, ObjectIndex &ride);
+TickResult ApplyHits(const Game &game, Rect &pos, const PlayerHits &hits, ObjectIndex &ride);
+TickResult StepGame(Game &game, Action action);
+void SeekGame(Game &game, unsigned long tick);
+
+void AddEnemy(Game &game, const Rng &levelRng);
+void AddLog(Game &game, Direction dir, const Rng &levelRng);
+void addEnemies(Game &game);
+void MoveArchetypes(Game &game);
+void ResetPlayerPos(Game &game);
+void NextLevel(Game &game);
+const Level & PoolLevel(const LevelPool &pool, int level);
+void LoadLevel(Game &game, const Level &level);
+int AddRow(Game &game);
+Rng LevelRng(const Game &game);
+Rng LaneRng(const Rng &levelRng, int lane);
+Rect EntityRect(const Game &game, const Lanes &lanes, size_t i);
+bool CheckCollision(const Rect &rect1, const Rect &rect2);
+int FirstHit(const Game &game, const Lanes &lanes, const Rect &rect);
+bool CheckEnemyCollisions(const Game &game);
+bool CheckLogCollisions(const Game &game);
+int getLog(const Game &game);
+ObjectIndex RideIndex(const Game &game);
+void SetRide(Game &game, const ObjectIndex &ride);
+
+#endif
@@ -0,0 +1,60 @@
+// triple buffered game snapshots for a separate render thread
+
+#include "frogger_snapshot.h"
+#include <algorithm>
+
+// set on middle when it holds a snapshot the reader hasn't taken yet
+const int snapshotFresh = 4;
+
+// slots start empty with room for a full game so taking snapshots never allocates
+void InitSnapshotBuffer(SnapshotBuffer &buffer){
+    for(auto &slot : buffer.slots){
+        slot.tick = 0;
+        slot.level = -1;
+        slot.player = Rect();
+        slot.topBar = Rect();
+        slot.bottomBar = Rect();
+        std::fill(slot.perfTotals, slot.perfTotals + PerfPhaseCount, 0.0);
+        for(auto &objects : slot.objects){
+            objects.clear();
+            objects.reserve(maxLaneObjects);
+        }
+    }
+    buffer.back = 0;
+    buffer.middle.store(1);
+    buffer.front = 2;
+}
+
+// copies what the renderer draws out of game
+void TakeSnapshot(Snapshot &snapshot, const Game &game){
+    snapshot.tick = game.ticks;
+    snapshot.level = game.level;
+    snapshot.player = game.playerPos;
+    snapshot.topBar = game.topBar;
+    snapshot.bottomBar = game.bottomBar;
+    for(int a = 0; a < ArchetypeCount; a++){
+        const Lanes &lanes = game.lanes[a];
+        std::vector<Rect> &objects = snapshot.objects[a];
+        objects.resize(LanesSize(lanes));
+        for(size_t i = 0; i < objects.size(); i++)
+            objects[i] = EntityRect(game, lanes, i);
+    }
+}
+
+// the writer's slot, only the writer thread may touch it
+Snapshot & SnapshotToWrite(SnapshotBuffer &buffer){
+    return buffer.slots[buffer.back];
+}
+
+// hands the writer's slot to the reader and takes the middle one back
+void PublishSnapshot(SnapshotBuffer &buffer){
+    buffer.back = buffer.middle.exchange(buffer.back | snapshotFresh, std::memory_order_acq_rel) & ~snapshotFresh;
+}
+
+// newest published snapshot, the same one again if nothing new came in
+// only the reader thread may call this, the snapshot stays valid until its next call
+const Snapshot & LatestSnapshot(SnapshotBuffer &buffer){
+    if(buffer.middle.load(std::memory_order_relaxed) & snapshotFresh)
+        buffer.front = buffer.middle.exchange(buffer.front, std::memory_order_acq_rel) & ~snapshotFresh;
+    return buffer.slots[buffer.front];
+}
@@ -0,0 +1,40 @@
+// what the renderer needs from a game, copied out after every batch of ticks
+// the simulation thread fills snapshots and the render thread draws them,
+// a triple buffer lets both run without ever waiting on each other
+
+#ifndef FROGGER_SNAPSHOT_H
+#define FROGGER_SNAPSHOT_H
+
+#include <atomic>
+#include <vector>
+#include "frogger_sim.h"
+#include "frogger_perf.h"
+
+struct Snapshot{
+    unsigned long tick;
+    int level;
+    Rect player;
+    Rect topBar;
+    Rect bottomBar;
+    std::vector<Rect> objects[ArchetypeCount]; // EntityRect of every object
+    double perfTotals[PerfPhaseCount];          // microseconds the writer spent per phase so far
+};
+
+// one writer and one reader, each owns a slot and they trade through middle
+// the writer never waits for the reader and the reader always gets the newest
+// snapshot, older unread ones are simply written over
+struct SnapshotBuffer{
+    Snapshot slots[3];
+    int back;                // slot the writer fills
+    int front;               // slot the reader draws
+    std::atomic<int> middle; // last published slot, plus snapshotFresh until read
+};
+
+// PROTOTYPES
+void InitSnapshotBuffer(SnapshotBuffer &buffer);
+void TakeSnapshot(Snapshot &snapshot, const Game &game);
+Snapshot & SnapshotToWrite(SnapshotBuffer &buffer);
+void PublishSnapshot(SnapshotBuffer &buffer);
+const Snapshot & LatestSnapshot(SnapshotBuffer &buffer);
+
+#endif
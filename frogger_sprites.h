@@ -0,0 +1,17 @@
+// ids of the sprites the game draws, kept free of SDL so the rules can name
+// which sprite each archetype is drawn with
+
+#ifndef FROGGER_SPRITES_H
+#define FROGGER_SPRITES_H
+
+enum SpriteId{
+    SpriteBackground,
+    SpriteBar,
+    SpriteFrog,
+    SpriteTruck,
+    SpriteLogLong,
+    SpriteGameOver,
+    SpriteCount
+};
+
+#endif
@@ -0,0 +1,279 @@
+// checks that every fast path gives the same answer as the simple code it stands in for
+// SIMD kernels against the scalar one, PositionAt against stepping, handles
+// across removals, the grid against a full scan and the batched env against single envs
+// prints one line per check and exits with 1 if any of them failed
+//
+// usage: frogger_test [--seed S]
+
+#include "frogger_batch.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <string.h>
+#include <stdlib.h>
+
+// counts and prints the outcome of one check
+static int Report(const char *name, unsigned long mismatches, unsigned long tries){
+    std::cout << (mismatches == 0 ? "ok     " : "FAILED ") << name << ": "
+              << mismatches << " mismatches in " << tries << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+// random objects with whole and fractional speeds in both directions, some off screen
+static void RandomObjects(Rng &rng, size_t count, std::vector<Fixed> &x, std::vector<Fixed> &w, std::vector<Fixed> &vel){
+    x.resize(count);
+    w.resize(count);
+    vel.resize(count);
+    for(size_t i = 0; i < count; i++){
+        w[i] = ToFixed(RandomBelow(rng, 60) + 1);
+        x[i] = RandomBelow(rng, ToFixed(envWidth) + 2 * w[i]) - w[i];
+        vel[i] = RandomBelow(rng, 9 * fixedOne) - 4 * fixedOne;
+    }
+}
+
+// every kernel this build and CPU have moves objects like MoveLanesScalar
+static int CheckKernels(uint64_t seed){
+    Rng rng = MakeRng(seed, 0);
+    unsigned long bad = 0, tries = 0;
+    std::vector<Fixed> x, w, vel;
+    for(size_t count = 0; count < 40; count++){
+        RandomObjects(rng, count, x, w, vel);
+        std::vector<Fixed> scalar = x;
+        std::vector<Fixed> best = x;
+#if defined(__SSE2__)
+        std::vector<Fixed> sse2 = x;
+#endif
+#if defined(FROGGER_AVX2_KERNEL)
+        std::vector<Fixed> avx2 = x;
+#endif
+        for(int t = 0; t < 400; t++, tries++){
+            MoveLanesScalar(scalar.data(), w.data(), vel.data(), count, ToFixed(envWidth));
+            MoveObjects(best.data(), w.data(), vel.data(), count, envWidth);
+            bad += best != scalar;
+#if defined(__SSE2__)
+            MoveLanesSSE2(sse2.data(), w.data(), vel.data(), count, ToFixed(envWidth));
+            bad += sse2 != scalar;
+#endif
+#if defined(FROGGER_AVX2_KERNEL)
+            if(CpuHasAVX2()){
+                MoveLanesAVX2(avx2.data(), w.data(), vel.data(), count, ToFixed(envWidth));
+                bad += avx2 != scalar;
+            }
+#endif
+        }
+    }
+    return Report("kernels match MoveLanesScalar", bad, tries);
+}
+
+// PositionAt lands where stepping tick by tick does
+static int CheckPositionAt(uint64_t seed){
+    Rng rng = MakeRng(seed, 1);
+    unsigned long bad = 0, tries = 0;
+    std::vector<Fixed> x, w, vel;
+    RandomObjects(rng, 64, x, w, vel);
+    std::vector<Fixed> spawnX = x;
+    for(unsigned long t = 1; t <= 2000; t++){
+        MoveLanesScalar(x.data(), w.data(), vel.data(), x.size(), ToFixed(envWidth));
+        for(size_t i = 0; i < x.size(); i++, tries++)
+            bad += PositionAt(spawnX[i], w[i], vel[i], t, ToFixed(envWidth)) != x[i];
+    }
+    return Report("PositionAt matches stepping", bad, tries);
+}
+
+// RemoveFromLanes leaves removed handles stale and every other handle
+// on its object, including the one moved into the gap
+static int CheckRemove(uint64_t seed){
+    Rng rng = MakeRng(seed, 4);
+    unsigned long bad = 0, tries = 0;
+    Lanes lanes;
+    ReserveLanes(lanes, 64);
+    std::vector<LaneHandle> live;
+    std::vector<Fixed> liveX; // x each live object was added with, all different
+    Fixed nextX = 0;
+    for(int op = 0; op < 4000; op++){
+        if(live.empty() || (live.size() < 64 && RandomBelow(rng, 2) == 0)){
+            live.push_back(AddToLanes(lanes, nextX, fixedOne, 0, 0));
+            liveX.push_back(nextX++);
+            continue;
+        }
+        size_t k = RandomBelow(rng, live.size());
+        LaneHandle removed = live[k];
+        bad += !RemoveFromLanes(lanes, removed);
+        bad += LaneIndex(lanes, removed) != -1;
+        bad += RemoveFromLanes(lanes, removed); // already stale
+        live[k] = live.back();
+        live.pop_back();
+        liveX[k] = liveX.back();
+        liveX.pop_back();
+
+        bad += LanesSize(lanes) != live.size();
+        for(size_t j = 0; j < live.size(); j++, tries++){
+            int i = LaneIndex(lanes, live[j]);
+            bad += i < 0 || lanes.x[i] != liveX[j];
+        }
+    }
+    return Report("RemoveFromLanes keeps handles right", bad, tries);
+}
+
+// copies of the normal layout's objects at random x until every lane holds
+// perLane of them, like the bench's FillGame, so QueryGrid bins the lanes
+static void CrowdLanes(Game &game, size_t perLane, Rng &rng){
+    for(int a = 0; a < ArchetypeCount; a++){
+        Lanes &lanes = game.lanes[a];
+        size_t base = LanesSize(lanes);
+        std::vector<bool> used(game.laneY.size(), false);
+        for(size_t i = 0; i < base; i++)
+            used[lanes.lane[i]] = true;
+        size_t count = perLane * std::count(used.begin(), used.end(), true);
+        ReserveLanes(lanes, std::max(count, maxLaneObjects));
+        for(size_t i = base; i < count; i++){
+            size_t from = i % base;
+            AddToLanes(lanes, ToFixed(RandomBelow(rng, game.windowRect.w)), lanes.w[from],
+                       lanes.vel[from], lanes.lane[from]);
+        }
+    }
+    RebuildGrid(game.grid, game);
+}
+
+// QueryGrid finds what ScanHits does, for players all over the board and over
+// many ticks and level ups, with perLane objects per lane if it is above 0
+static int CheckGrid(uint64_t seed, size_t perLane, const char *name){
+    Game game;
+    InitGame(game, envWidth, envHeight, seed);
+    Rng rng = MakeRng(seed, 2);
+    if(perLane > 0)
+        CrowdLanes(game, perLane, rng);
+    unsigned long bad = 0, tries = 0;
+    for(int level = 0; level < 4; level++){
+        for(int t = 0; t < 600; t++){
+            game.ticks++;
+            MoveArchetypes(game);
+            for(int k = 0; k < 8; k++, tries++){
+                Rect player = {RandomBelow(rng, envWidth + 40) - 20, RandomBelow(rng, envHeight), 20, 15};
+                PlayerHits grid = QueryGrid(game.grid, game, player);
+                PlayerHits scan = ScanHits(game, player);
+                bad += grid.hitEnemy != scan.hitEnemy || grid.ride.index != scan.ride.index
+                    || (scan.ride.index >= 0 && grid.ride.archetype != scan.ride.archetype);
+            }
+        }
+        NextLevel(game);
+    }
+
+    // a crowded check that never went through the binned path checked nothing new
+    if(perLane > gridScanLimit)
+        for(const GridLane &lane : game.grid.lanes)
+            bad += lane.members.size() <= gridScanLimit;
+    return Report(name, bad, tries);
+}
+
+// SeekGame leaves the game as stepping the ticks in between does, for a
+// player waiting at the bottom, even if it was carried by a log before
+static int CheckSeek(uint64_t seed){
+    Game stepped;
+    InitGame(stepped, envWidth, envHeight, seed);
+    NextLevel(stepped); // a level that doesn't start on tick 0
+    Game sought = stepped;
+    unsigned long bad = 0, tries = 0;
+    for(int t = 0; t < 3000; t++){
+        StepGame(stepped, NoAction);
+        if(t % 7 != 0) continue;
+        sought.rideCarry = fixedOne / 3; // left over from a log ridden earlier
+        SeekGame(sought, stepped.ticks);
+        for(int a = 0; a < ArchetypeCount; a++)
+            bad += sought.lanes[a].x != stepped.lanes[a].x;
+        bad += RideIndex(sought).index != RideIndex(stepped).index;
+        bad += sought.rideCarry != stepped.rideCarry;
+        tries++;
+    }
+    return Report("SeekGame matches stepping", bad, tries);
+}
+
+static bool SameObservation(const EnvObservation &a, const EnvObservation &b){
+    return a.playerX == b.playerX && a.playerY == b.playerY && a.onLog == b.onLog
+        && a.level == b.level && memcmp(a.view, b.view, sizeof(a.view)) == 0;
+}
+
+// heads up unless the view says that kills, with some random moves mixed in,
+// so games get across and level up often enough to check respawns too
+static Action TestPolicy(Rng &rng, const EnvObservation &obs){
+    auto safe = [&](int r, int c){
+        unsigned char f = obs.view[r][c];
+        return !(f & Lethal) && (!(f & envWater) || (f & Rideable));
+    };
+    if(RandomBelow(rng, 10) < 2) return (Action)RandomBelow(rng, envActionCount);
+    if(safe(0, 1)) return MoveUp;
+    if(safe(1, 1)) return NoAction;
+    return safe(1, 0) ? MoveLeft : MoveRight;
+}
+
+// a batch steps every game like an Env of its own would, with any number of threads
+static int CheckBatch(uint64_t seed){
+    const int games = 40;
+    const int steps = 6000;
+    BatchEnv single, threaded;
+    InitBatch(single, games, seed, 1);
+    InitBatch(threaded, games, seed, 3);
+
+    // the envs take their episode seeds from the same streams the batch does
+    std::vector<Env> envs(games);
+    std::vector<Rng> episodes(games);
+    Rng streams = MakeRng(seed, EnvStreams);
+    for(int g = 0; g < games; g++){
+        InitEnv(envs[g]);
+        episodes[g] = SplitRng(streams, g);
+        ResetEnv(envs[g], NextRandom(episodes[g]));
+    }
+
+    Rng policy = MakeRng(seed, PolicyStreams);
+    std::vector<Action> actions(games);
+    unsigned long bad = 0, badThreads = 0, tries = 0, levels = 0;
+    for(int s = 0; s < steps; s++){
+        for(int g = 0; g < games; g++)
+            actions[g] = TestPolicy(policy, single.obs[g]);
+        StepBatch(single, actions.data());
+        StepBatch(threaded, actions.data());
+
+        for(int g = 0; g < games; g++, tries++){
+            EnvStep step = StepEnv(envs[g], actions[g]);
+            levels += step.result == LevelUp;
+            EnvObservation obs = step.obs;
+            if(step.done)
+                obs = ResetEnv(envs[g], NextRandom(episodes[g]));
+            bad += step.reward != single.rewards[g] || step.done != (bool)single.dones[g]
+                || !SameObservation(obs, single.obs[g]);
+            badThreads += threaded.rewards[g] != single.rewards[g] || threaded.dones[g] != single.dones[g]
+                || !SameObservation(threaded.obs[g], single.obs[g]);
+        }
+    }
+    StopBatch(single);
+    StopBatch(threaded);
+
+    int failed = Report("batch matches single envs", bad, tries);
+    failed += Report("batch matches across thread counts", badThreads, tries);
+    if(levels == 0)
+        failed += Report("batch games reached a level up", 1, 1);
+    return failed;
+}
+
+int main(int argc, char*args[]){
+    uint64_t seed = 1;
+    for(int i = 1; i < argc; i++){
+        std::string arg = args[i];
+        if(arg == "--seed" && i + 1 < argc)
+            seed = strtoull(args[++i], NULL, 10);
+        else{
+            std::cerr << "usage: " << args[0] << " [--seed S]" << std::endl;
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    failed += CheckKernels(seed);
+    failed += CheckPositionAt(seed);
+    failed += CheckRemove(seed);
+    failed += CheckGrid(seed, 0, "QueryGrid matches ScanHits");
+    failed += CheckGrid(seed, 200, "QueryGrid matches ScanHits, 200 per lane");
+    failed += CheckSeek(seed);
+    failed += CheckBatch(seed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// textures the window keeps resident, keyed by name so one is only made once
+
+#include "frogger_textures.h"
+
+const TextureHandle noTexture = {-1, 0};
+
+void InitTextureCache(TextureCache &cache){
+    cache.slots.clear();
+    cache.freeSlots.clear();
+    cache.byKey.clear();
+    cache.hits = 0;
+    cache.misses = 0;
+    cache.bytesResident = 0;
+}
+
+static void FreeSlot(TextureCache &cache, int slot){
+    CachedTexture &entry = cache.slots[slot];
+    SDL_DestroyTexture(entry.texture);
+    cache.bytesResident -= entry.bytes;
+    cache.byKey.erase(entry.key);
+    entry.key.clear();
+    entry.texture = NULL;
+    entry.bytes = 0;
+    entry.refs = 0;
+    entry.generation++;
+    cache.freeSlots.push_back(slot);
+}
+
+// hands a texture made by the caller to the cache under key, counted as a miss
+// the cache destroys it from now on, returns a held handle
+// a texture already under key is destroyed and replaced, its handles give the new one
+TextureHandle AdoptTexture(TextureCache &cache, const std::string &key, SDL_Texture *texture){
+    if(texture == NULL) return noTexture;
+    cache.misses++;
+
+    int w = 0;
+    int h = 0;
+    SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+
+    auto found = cache.byKey.find(key);
+    if(found != cache.byKey.end()){
+        CachedTexture &entry = cache.slots[found->second];
+        if(entry.texture != texture)
+            SDL_DestroyTexture(entry.texture);
+        cache.bytesResident -= entry.bytes;
+        entry.texture = texture;
+        entry.bytes = (size_t)w * h * 4;
+        entry.refs++;
+        cache.bytesResident += entry.bytes;
+        TextureHandle handle = {found->second, entry.generation};
+        return handle;
+    }
+
+    int slot;
+    if(!cache.freeSlots.empty()){
+        slot = cache.freeSlots.back();
+        cache.freeSlots.pop_back();
+    }
+    else{
+        slot = cache.slots.size();
+        CachedTexture empty = {std::string(), NULL, 0, 0, 0};
+        cache.slots.push_back(empty);
+    }
+
+    CachedTexture &entry = cache.slots[slot];
+    entry.key = key;
+    entry.texture = texture;
+    entry.bytes = (size_t)w * h * 4;
+    entry.refs = 1;
+    cache.byKey[key] = slot;
+    cache.bytesResident += entry.bytes;
+
+    TextureHandle handle = {slot, entry.generation};
+    return handle;
+}
+
+// handle to the texture under key, held until ReleaseTexture
+// a handle to nothing if no texture was adopted under key
+TextureHandle AcquireTexture(TextureCache &cache, const std::string &key){
+    auto found = cache.byKey.find(key);
+    if(found == cache.byKey.end()) return noTexture;
+    CachedTexture &entry = cache.slots[found->second];
+    entry.refs++;
+    cache.hits++;
+    TextureHandle handle = {found->second, entry.generation};
+    return handle;
+}
+
+// texture behind a handle, NULL if the handle is empty or stale
+SDL_Texture * GetTexture(const TextureCache &cache, TextureHandle handle){
+    if(handle.slot < 0 || handle.slot >= (int)cache.slots.size()) return NULL;
+    const CachedTexture &entry = cache.slots[handle.slot];
+    if(entry.generation != handle.generation) return NULL;
+    return entry.texture;
+}
+
+// gives a handle back and empties it, the texture stays resident
+void ReleaseTexture(TextureCache &cache, TextureHandle &handle){
+    if(GetTexture(cache, handle) != NULL){
+        CachedTexture &entry = cache.slots[handle.slot];
+        if(entry.refs > 0) entry.refs--;
+    }
+    handle = noTexture;
+}
+
+// destroys every texture, outstanding handles go stale
+void ClearTextureCache(TextureCache &cache){
+    for(size_t slot = 0; slot < cache.slots.size(); slot++)
+        if(cache.slots[slot].texture != NULL)
+            FreeSlot(cache, slot);
+}
@@ -0,0 +1,48 @@
+// textures the window keeps resident, keyed by name so one is only made once
+// users hold a handle between AcquireTexture and ReleaseTexture, the cache
+// owns every texture and destroys them all in ClearTextureCache
+
+#ifndef FROGGER_TEXTURES_H
+#define FROGGER_TEXTURES_H
+
+#include <SDL2/SDL.h>
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// refers to one cache slot, stale once the slot is freed and reused
+struct TextureHandle{
+    int slot;            // -1 for no texture
+    unsigned generation;
+};
+
+struct CachedTexture{
+    std::string key;
+    SDL_Texture *texture; // NULL if the slot is free
+    size_t bytes;         // w * h * 4
+    int refs;             // handles currently acquired
+    unsigned generation;  // bumped every time the slot is freed
+};
+
+struct TextureCache{
+    std::vector<CachedTexture> slots;
+    std::vector<int> freeSlots;
+    std::unordered_map<std::string, int> byKey;
+
+    unsigned long hits;   // acquires that found the texture resident
+    unsigned long misses; // textures that had to be made, see AdoptTexture
+    size_t bytesResident; // pixel bytes of every resident texture
+};
+
+extern const TextureHandle noTexture;
+
+// PROTOTYPES
+void InitTextureCache(TextureCache &cache);
+TextureHandle AdoptTexture(TextureCache &cache, const std::string &key, SDL_Texture *texture);
+TextureHandle AcquireTexture(TextureCache &cache, const std::string &key);
+SDL_Texture * GetTexture(const TextureCache &cache, TextureHandle handle);
+void ReleaseTexture(TextureCache &cache, TextureHandle &handle);
+void ClearTextureCache(TextureCache &cache);
+
+#endif